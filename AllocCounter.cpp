@@ -0,0 +1,115 @@
+#include "AllocCounter.h"
+#include <algorithm>
+#include <atomic>
+#include <cstdlib>
+#include <new>
+#ifdef _WIN32
+#include <malloc.h>
+#endif
+using namespace std;
+
+static atomic<long long> allocationCounts[(int)AllocTag::COUNT];
+static atomic<long long> byteCounts[(int)AllocTag::COUNT];
+
+const char* AllocTagName(AllocTag tag) {
+    switch (tag) {
+        case AllocTag::OTHER: return "other";
+        case AllocTag::UNITS: return "units";
+        case AllocTag::TOWERS: return "towers";
+        case AllocTag::PROJECTILES: return "projectiles";
+        case AllocTag::WAVES: return "waves";
+        case AllocTag::SNAPSHOT: return "snapshot";
+        case AllocTag::RENDER: return "render";
+        default: return "?";
+    }
+}
+
+AllocReport TakeAllocReport() {
+    AllocReport report;
+    for (int t = 0; t < (int)AllocTag::COUNT; t++) {
+        report.tags[t].allocations = allocationCounts[t].exchange(0, memory_order_relaxed);
+        report.tags[t].bytes = byteCounts[t].exchange(0, memory_order_relaxed);
+    }
+    return report;
+}
+
+static void CountAllocation(size_t size) {
+    int tag = (int)currentAllocTag;
+    allocationCounts[tag].fetch_add(1, memory_order_relaxed);
+    byteCounts[tag].fetch_add((long long)size, memory_order_relaxed);
+}
+
+void* operator new(size_t size) {
+    CountAllocation(size);
+    if (void* p = malloc(size ? size : 1)) return p;
+    throw bad_alloc();
+}
+
+void* operator new[](size_t size) {
+    return operator new(size);
+}
+
+void* operator new(size_t size, const nothrow_t&) noexcept {
+    try {
+        return operator new(size);
+    } catch (...) {
+        return nullptr;
+    }
+}
+
+void* operator new[](size_t size, const nothrow_t&) noexcept {
+    return operator new(size, nothrow);
+}
+
+void operator delete(void* p) noexcept { free(p); }
+void operator delete[](void* p) noexcept { free(p); }
+void operator delete(void* p, size_t) noexcept { free(p); }
+void operator delete[](void* p, size_t) noexcept { free(p); }
+void operator delete(void* p, const nothrow_t&) noexcept { free(p); }
+void operator delete[](void* p, const nothrow_t&) noexcept { free(p); }
+
+// Over-aligned types (alignas beyond max_align_t) come through these. The
+// library's defaults would not be counted.
+
+void* operator new(size_t size, align_val_t align) {
+    CountAllocation(size);
+    size_t alignment = max((size_t)align, sizeof(void*));
+#ifdef _WIN32
+    if (void* p = _aligned_malloc(size ? size : 1, alignment)) return p;
+#else
+    void* p = nullptr;
+    if (posix_memalign(&p, alignment, size ? size : 1) == 0) return p;
+#endif
+    throw bad_alloc();
+}
+
+void* operator new[](size_t size, align_val_t align) {
+    return operator new(size, align);
+}
+
+void* operator new(size_t size, align_val_t align, const nothrow_t&) noexcept {
+    try {
+        return operator new(size, align);
+    } catch (...) {
+        return nullptr;
+    }
+}
+
+void* operator new[](size_t size, align_val_t align, const nothrow_t&) noexcept {
+    return operator new(size, align, nothrow);
+}
+
+static void FreeAligned(void* p) {
+#ifdef _WIN32
+    _aligned_free(p);
+#else
+    free(p);
+#endif
+}
+
+void operator delete(void* p, align_val_t) noexcept { FreeAligned(p); }
+void operator delete[](void* p, align_val_t) noexcept { FreeAligned(p); }
+void operator delete(void* p, size_t, align_val_t) noexcept { FreeAligned(p); }
+void operator delete[](void* p, size_t, align_val_t) noexcept { FreeAligned(p); }
+void operator delete(void* p, align_val_t, const nothrow_t&) noexcept { FreeAligned(p); }
+void operator delete[](void* p, align_val_t, const nothrow_t&) noexcept { FreeAligned(p); }
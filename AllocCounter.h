@@ -0,0 +1,58 @@
+/*
+	Allocation accounting. Linking AllocCounter.cpp replaces the global
+	operator new / delete with versions that count every allocation and the
+	bytes asked for, against the subsystem tag of the allocating thread.
+	Code marks its subsystem with an AllocScope; without AllocCounter.cpp the
+	scopes still compile and nothing is counted.
+*/
+#pragma once
+
+enum class AllocTag : unsigned char {
+    OTHER,
+    UNITS,
+    TOWERS,
+    PROJECTILES,
+    WAVES,
+    SNAPSHOT,
+    RENDER,
+    COUNT
+};
+
+struct AllocCount {
+    long long allocations = 0;
+    long long bytes = 0;
+};
+
+struct AllocReport {
+    AllocCount tags[(int)AllocTag::COUNT];
+
+    AllocCount Total() const {
+        AllocCount total;
+        for (const AllocCount& count : tags) {
+            total.allocations += count.allocations;
+            total.bytes += count.bytes;
+        }
+        return total;
+    }
+};
+
+// Subsystem the calling thread's allocations are counted against
+inline thread_local AllocTag currentAllocTag = AllocTag::OTHER;
+
+// Counts this thread's allocations inside the scope against tag
+class AllocScope {
+public:
+    explicit AllocScope(AllocTag tag) : previous(currentAllocTag) { currentAllocTag = tag; }
+    ~AllocScope() { currentAllocTag = previous; }
+    AllocScope(const AllocScope&) = delete;
+    AllocScope& operator = (const AllocScope&) = delete;
+
+private:
+    AllocTag previous;
+};
+
+// The rest needs AllocCounter.cpp
+
+const char* AllocTagName(AllocTag tag);
+// Allocations on every thread since the last call, then starts over
+AllocReport TakeAllocReport();
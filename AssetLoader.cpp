@@ -0,0 +1,125 @@
+#include "AssetLoader.h"
+#include <algorithm>
+#include <chrono>
+using namespace std;
+
+AssetLoader::AssetLoader(int count) : workerCount(max(count, 1)) {}
+
+AssetLoader::~AssetLoader() {
+    for (auto& worker : workers) {
+        worker.join();
+    }
+    // Decoded but never uploaded
+    for (Asset& asset : assets) {
+        if (asset.image.data) UnloadImage(asset.image);
+        if (asset.wave.data) UnloadWave(asset.wave);
+    }
+}
+
+int AssetLoader::AddTexture(const string& fileName) {
+    Asset asset;
+    asset.kind = Kind::TEXTURE;
+    asset.fileName = fileName;
+    assets.push_back(asset);
+    return (int)assets.size() - 1;
+}
+
+int AssetLoader::AddSound(const string& fileName) {
+    Asset asset;
+    asset.kind = Kind::SOUND;
+    asset.fileName = fileName;
+    assets.push_back(asset);
+    return (int)assets.size() - 1;
+}
+
+void AssetLoader::Start() {
+    if (!workers.empty()) return;
+    for (int t = 0; t < workerCount; t++) {
+        workers.emplace_back(&AssetLoader::WorkerLoop, this, t == 0);
+    }
+}
+
+void AssetLoader::WorkerLoop(bool openAudio) {
+    if (openAudio) {
+        InitAudioDevice();
+        audioReady.store(true);
+    }
+
+    for (;;) {
+        int id = nextToDecode.fetch_add(1);
+        if (id >= (int)assets.size()) return;
+        Decode(assets[id]);
+        lock_guard<mutex> guard(readyLock);
+        (assets[id].kind == Kind::TEXTURE ? readyTextures : readySounds).push_back(id);
+    }
+}
+
+// File I/O and decode only, nothing here may touch GL or the audio device
+void AssetLoader::Decode(Asset& asset) {
+    int size = 0;
+    unsigned char* data = LoadFileData(asset.fileName.c_str(), &size);
+    if (!data) return;
+
+    const char* type = GetFileExtension(asset.fileName.c_str());
+    if (type) {
+        if (asset.kind == Kind::TEXTURE) {
+            asset.image = LoadImageFromMemory(type, data, size);
+        } else {
+            asset.wave = LoadWaveFromMemory(type, data, size);
+        }
+    }
+    UnloadFileData(data);
+}
+
+void AssetLoader::Upload(double budget) {
+    auto start = chrono::steady_clock::now();
+    for (;;) {
+        int id;
+        {
+            lock_guard<mutex> guard(readyLock);
+            // Sounds have to wait for the audio device, textures never do
+            deque<int>* queue = &readyTextures;
+            if (queue->empty() && audioReady.load()) queue = &readySounds;
+            if (queue->empty()) return;
+            id = queue->front();
+            queue->pop_front();
+        }
+
+        Asset& asset = assets[id];
+        if (asset.kind == Kind::TEXTURE) {
+            if (asset.image.data) {
+                asset.texture = LoadTextureFromImage(asset.image);
+                UnloadImage(asset.image);
+                asset.image = {};
+            }
+        } else {
+            if (asset.wave.data) {
+                asset.sound = LoadSoundFromWave(asset.wave);
+                UnloadWave(asset.wave);
+                asset.wave = {};
+            }
+        }
+        uploaded++;
+
+        if (chrono::duration<double>(chrono::steady_clock::now() - start).count() >= budget) return;
+    }
+}
+
+bool AssetLoader::Done() const {
+    return uploaded == (int)assets.size() && audioReady.load();
+}
+
+float AssetLoader::Progress() const {
+    // The audio device counts as one more asset
+    int done = uploaded + (audioReady.load() ? 1 : 0);
+    return (float)done / (float)(assets.size() + 1);
+}
+
+void AssetLoader::Unload() {
+    for (Asset& asset : assets) {
+        if (asset.texture.id > 0) UnloadTexture(asset.texture);
+        if (asset.sound.stream.buffer) UnloadSound(asset.sound);
+        asset.texture = {};
+        asset.sound = {};
+    }
+}
@@ -0,0 +1,82 @@
+/*
+	Loads assets while the start screen is already drawing. Worker threads
+	read and decode the files (and open the audio device); the window thread
+	turns the decoded data into textures and sounds a few at a time each
+	frame, since GPU upload has to happen on the thread that owns the GL
+	context.
+*/
+#pragma once
+
+#include "raylib.h"
+#include <atomic>
+#include <deque>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+class AssetLoader {
+public:
+    explicit AssetLoader(int workerCount = 2);
+    ~AssetLoader();
+    AssetLoader(const AssetLoader&) = delete;
+    AssetLoader& operator = (const AssetLoader&) = delete;
+
+    // Before Start. The returned id picks the asset out once it is loaded.
+    int AddTexture(const std::string& fileName);
+    int AddSound(const std::string& fileName);
+
+    // Starts the workers; the first one opens the audio device before
+    // decoding anything
+    void Start();
+
+    // Window thread, once per frame. Uploads decoded assets until budget
+    // seconds have passed, always at least one if one is ready.
+    void Upload(double budget);
+
+    bool AudioReady() const { return audioReady.load(); }
+    // Every asset uploaded and the audio device open
+    bool Done() const;
+    // 0 to 1, for the loading bar
+    float Progress() const;
+
+    // Valid once Done, empty if the file could not be loaded
+    Texture2D GetTexture(int id) const { return assets[id].texture; }
+    Sound GetSound(int id) const { return assets[id].sound; }
+
+    // Window thread, before CloseWindow
+    void Unload();
+
+private:
+    enum class Kind : unsigned char {
+        TEXTURE,
+        SOUND
+    };
+
+    struct Asset {
+        Kind kind;
+        std::string fileName;
+        // Decoded by a worker
+        Image image = {};
+        Wave wave = {};
+        // Made by Upload
+        Texture2D texture = {};
+        Sound sound = {};
+    };
+
+    int workerCount;
+    std::vector<Asset> assets;
+    std::vector<std::thread> workers;
+    std::atomic<int> nextToDecode{ 0 };
+    std::atomic<bool> audioReady{ false };
+
+    std::mutex readyLock;
+    // Decoded, waiting for Upload. Sounds queue apart so they never hold up
+    // textures while the audio device is still opening.
+    std::deque<int> readyTextures;
+    std::deque<int> readySounds;
+    int uploaded = 0;
+
+    void WorkerLoop(bool openAudio);
+    void Decode(Asset& asset);
+};
@@ -0,0 +1,205 @@
+/*
+	Simulation tick cost benchmark. Builds deterministic lane scenarios with
+	10 to 100k units per side and reports, per phase of Game::Update, the
+	cost in nanoseconds per unit per tick as JSON.
+
+	Build: g++ -std=c++17 -O2 -pthread Simulation.cpp JobSystem.cpp Bench.cpp -o bench
+	Usage: bench [--max UNITS_PER_SIDE] [--out FILE] [--threads N]
+
+	--threads runs the phases with N job system workers besides the main
+	thread (default 0).
+
+	Phases:
+	  lane_index          UnitStore::RefreshLaneIndex
+	  unit_update         Game::UpdateUnits (movement, retargeting, attacks), lane index
+	                      refreshed untimed between ticks
+	  movement            the path-following kernel (QueueMove + MoveQueued) for every unit
+	  targeting           UnitStore::FindTargetWithPriority for every unit
+	  splash              a wizard splash radius query around every unit
+	  tower_queue         Game::UpdateTowers plus both towers picking a target
+	  projectile_update   Game::UpdateProjectiles, one live effect per unit
+	  wave_progression    Game::HandleWaveProgression
+*/
+
+#include "Simulation.h"
+#include "JobSystem.h"
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <functional>
+#include <vector>
+using namespace std;
+
+const int SCENARIO_SIZES[] = { 10, 100, 1000, 10000, 100000 };
+
+// Each phase runs for at least this long (or MAX_TICKS ticks) per scenario
+const double MIN_PHASE_SECONDS = 0.2;
+const int MAX_TICKS = 200;
+
+// Restarts the match and spreads unitsPerSide units of each side evenly over
+// the middle of the lane, cycling through the unit types. Every unit gets a
+// path cursor pointing at the next waypoint ahead of it.
+void BuildScenario(Game& game, int unitsPerSide) {
+    game.Restart();
+    UnitStore& units = game.units;
+
+    for (int side = 0; side < 2; side++) {
+        bool player = side == 1;
+        for (int n = 0; n < unitsPerSide; n++) {
+            UnitHandle handle = units.Spawn((UnitType)(n % ((int)UnitType::WIZARD + 1)), player);
+            int i = units.IndexOf(handle);
+
+            float x = 250.0f + 700.0f * (n + 0.5f) / unitsPerSide;
+            units.posX[i] = x;
+
+            const vector<Vec2>& waypoints = units.Waypoints(i);
+            int cursor = 0;
+            while (cursor < (int)waypoints.size() &&
+                   (player ? waypoints[cursor].x <= x : waypoints[cursor].x >= x)) {
+                cursor++;
+            }
+            units.pathCursor[i] = cursor;
+        }
+    }
+    units.RefreshLaneIndex(SIM_DT);
+    // Frame arenas big enough for the new unit count
+    game.ResetArenas();
+}
+
+// Runs one phase on a fresh scenario until it has taken long enough and
+// returns nanoseconds per unit per tick. between runs untimed after every
+// tick, to keep up what the rest of a real tick would.
+double TimePhase(Game& game, int unitsPerSide, const function<void(Game&)>& setup,
+                 const function<void(Game&)>& tick, const function<void(Game&)>& between = nullptr) {
+    BuildScenario(game, unitsPerSide);
+    if (setup) setup(game);
+
+    double units = 2.0 * unitsPerSide;
+    double elapsed = 0.0;
+    int ticks = 0;
+    while (ticks < MAX_TICKS && (ticks == 0 || elapsed < MIN_PHASE_SECONDS)) {
+        auto start = chrono::steady_clock::now();
+        tick(game);
+        auto end = chrono::steady_clock::now();
+        elapsed += chrono::duration<double>(end - start).count();
+        ticks++;
+        if (between) between(game);
+    }
+    return elapsed * 1e9 / (ticks * units);
+}
+
+int main(int argc, char** argv) {
+    int maxUnits = 100000;
+    const char* outPath = nullptr;
+    int threads = 0;
+
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--max") == 0 && i + 1 < argc) {
+            maxUnits = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--out") == 0 && i + 1 < argc) {
+            outPath = argv[++i];
+        } else if (strcmp(argv[i], "--threads") == 0 && i + 1 < argc) {
+            threads = atoi(argv[++i]);
+        } else {
+            fprintf(stderr, "usage: %s [--max UNITS_PER_SIDE] [--out FILE] [--threads N]\n", argv[0]);
+            return 1;
+        }
+    }
+
+    FILE* out = outPath ? fopen(outPath, "w") : stdout;
+    if (!out) {
+        fprintf(stderr, "cannot open %s\n", outPath);
+        return 1;
+    }
+
+    JobSystem jobs(threads);
+    // Query results for the targeting and splash phases
+    vector<FrameArena> arenas(jobs.ThreadCount());
+    for (FrameArena& arena : arenas) {
+        arena.Reserve((size_t)maxUnits * 2 * ARENA_BYTES_PER_UNIT);
+    }
+    vector<long long> splashSink(jobs.ThreadCount());
+    vector<MoveBatch> moveBatches(jobs.ThreadCount());
+    Game game;
+    game.SetJobSystem(&jobs);
+
+    fprintf(out, "{\n  \"unit\": \"ns_per_unit_per_tick\",\n  \"threads\": %d,\n  \"scenarios\": [",
+            jobs.ThreadCount());
+    bool first = true;
+    for (int unitsPerSide : SCENARIO_SIZES) {
+        if (unitsPerSide > maxUnits) break;
+
+        double laneIndex = TimePhase(game, unitsPerSide, nullptr, [](Game& g) {
+            g.units.RefreshLaneIndex(SIM_DT);
+        });
+        // The lane refresh keeps targeting on the one-tick slack a real tick sees
+        double unitUpdate = TimePhase(game, unitsPerSide, nullptr, [](Game& g) {
+            g.UpdateUnits(SIM_DT);
+        }, [](Game& g) {
+            g.units.RefreshLaneIndex(SIM_DT);
+        });
+        double movement = TimePhase(game, unitsPerSide, nullptr, [&](Game& g) {
+            g.units.BeginUpdates();
+            jobs.ParallelFor(g.units.Count(), 256, [&](int begin, int end, int thread) {
+                for (int i = begin; i < end; i++) {
+                    g.units.QueueMove(i, moveBatches[thread]);
+                }
+                g.units.MoveQueued(moveBatches[thread], SIM_DT);
+            });
+        });
+        double targeting = TimePhase(game, unitsPerSide, nullptr, [&](Game& g) {
+            jobs.ParallelFor(g.units.Count(), 64, [&](int begin, int end, int thread) {
+                for (int i = begin; i < end; i++) {
+                    g.units.FindTargetWithPriority(i, arenas[thread]);
+                }
+            });
+        });
+        double splash = TimePhase(game, unitsPerSide, nullptr, [&](Game& g) {
+            jobs.ParallelFor(g.units.Count(), 64, [&](int begin, int end, int thread) {
+                for (int i = begin; i < end; i++) {
+                    ArenaScope scope(arenas[thread]);
+                    ArenaVector<int> hits(arenas[thread]);
+                    g.units.QueryRadius(!g.units.isPlayer[i], { g.units.posX[i], g.units.posY[i] }, 60.0f, hits);
+                    splashSink[thread] += (long long)hits.size();
+                }
+            });
+        });
+        double towerQueue = TimePhase(game, unitsPerSide, nullptr, [](Game& g) {
+            g.UpdateTowers(SIM_DT);
+            g.playerTower.GetBestTarget(g.units);
+            g.enemyTower.GetBestTarget(g.units);
+        });
+        double projectileUpdate = TimePhase(game, unitsPerSide, [](Game& g) {
+            int count = g.units.Count();
+            if (g.projectiles.Capacity() < count) g.projectiles.SetCapacity(count);
+            // Oldest first, so they expire from the front like in a match
+            for (int i = 0; i < count; i++) {
+                Projectile projectile({ g.units.posX[i], g.units.posY[i] }, { 50.0f, LANE_Y }, PALETTE_RED);
+                projectile.progress = (float)(count - 1 - i) / count;
+                g.projectiles.Push(projectile);
+            }
+        }, [](Game& g) {
+            g.UpdateProjectiles(SIM_DT);
+        });
+        double waveProgression = TimePhase(game, unitsPerSide, nullptr, [](Game& g) {
+            g.HandleWaveProgression(SIM_DT);
+        });
+
+        fprintf(out, "%s\n    {\"units_per_side\": %d, \"phases\": {"
+                "\"lane_index\": %.3f, \"unit_update\": %.3f, \"movement\": %.3f, \"targeting\": %.3f, \"splash\": %.3f, "
+                "\"tower_queue\": %.3f, \"projectile_update\": %.3f, \"wave_progression\": %.3f}}",
+                first ? "" : ",", unitsPerSide, laneIndex, unitUpdate, movement, targeting, splash,
+                towerQueue, projectileUpdate, waveProgression);
+        fflush(out);
+        first = false;
+    }
+    fprintf(out, "\n  ]\n}\n");
+
+    if (out != stdout) fclose(out);
+    // Keeps the splash queries from being optimized away
+    long long totalSplash = 0;
+    for (long long sink : splashSink) totalSplash += sink;
+    if (totalSplash < 0) printf("%lld\n", totalSplash);
+    return 0;
+}
@@ -0,0 +1,122 @@
+/*
+	Linear arena for temporaries that live no longer than one simulation
+	tick. Allocation bumps an offset and freeing does nothing; the game
+	resets each thread's arena at the start of every tick, and an
+	ArenaScope hands back everything allocated inside it on exit, so a loop
+	of queries reuses the same bytes. ArenaVector is a std::vector that
+	allocates from an arena.
+
+	Running out of space aborts with a message in debug builds. With NDEBUG
+	the allocation falls back to the heap, which the allocation gate
+	(AllocCounter.h) then reports.
+*/
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdio>
+#include <cstdlib>
+#include <functional>
+#include <memory>
+#include <new>
+#include <vector>
+
+struct FrameArenaStats {
+    size_t capacity = 0;
+    size_t peak = 0;          // most bytes in use at once, overflowing requests included
+    long long overflows = 0;  // allocations that went to the heap instead
+};
+
+class FrameArena {
+public:
+    FrameArena() = default;
+    explicit FrameArena(size_t capacity) { Reserve(capacity); }
+
+    // Replaces the buffer, so nothing may still point into it. Keeps the
+    // stats.
+    void Reserve(size_t capacity) {
+        buffer.reset(capacity ? new unsigned char[capacity] : nullptr);
+        stats.capacity = capacity;
+        used = 0;
+    }
+
+    void* Allocate(size_t bytes, size_t align) {
+        size_t start = (used + align - 1) & ~(align - 1);
+        stats.peak = std::max(stats.peak, start + bytes);
+        if (start + bytes > stats.capacity) return Overflow(bytes);
+        used = start + bytes;
+        return buffer.get() + start;
+    }
+
+    // Only heap fallbacks need freeing, arena memory comes back on Reset / Rewind
+    void Free(void* p) {
+        if (!Owns(p)) ::operator delete(p);
+    }
+
+    bool Owns(const void* p) const {
+        const unsigned char* begin = buffer.get();
+        std::less_equal<const void*> lessEqual;
+        return begin && lessEqual(begin, p) && !lessEqual(begin + stats.capacity, p);
+    }
+
+    void Reset() { used = 0; }
+    size_t Used() const { return used; }
+    void Rewind(size_t mark) { used = mark; }
+
+    const FrameArenaStats& Stats() const { return stats; }
+
+private:
+    std::unique_ptr<unsigned char[]> buffer;
+    size_t used = 0;
+    FrameArenaStats stats;
+
+    void* Overflow(size_t bytes) {
+#ifndef NDEBUG
+        fprintf(stderr, "FrameArena: out of space, %zu of %zu bytes in use and %zu more asked for\n",
+                used, stats.capacity, bytes);
+        abort();
+#else
+        stats.overflows++;
+        return ::operator new(bytes);
+#endif
+    }
+};
+
+// Gives back everything allocated from arena inside the scope
+class ArenaScope {
+public:
+    explicit ArenaScope(FrameArena& arena) : arena(arena), mark(arena.Used()) {}
+    ~ArenaScope() { arena.Rewind(mark); }
+    ArenaScope(const ArenaScope&) = delete;
+    ArenaScope& operator = (const ArenaScope&) = delete;
+
+private:
+    FrameArena& arena;
+    size_t mark;
+};
+
+template <typename T>
+class ArenaAllocator {
+public:
+    using value_type = T;
+
+    ArenaAllocator(FrameArena& arena) : arena(&arena) {}
+    template <typename U>
+    ArenaAllocator(const ArenaAllocator<U>& other) : arena(other.arena) {}
+
+    T* allocate(size_t n) { return (T*)arena->Allocate(n * sizeof(T), alignof(T)); }
+    void deallocate(T* p, size_t) { arena->Free(p); }
+
+    template <typename U>
+    bool operator == (const ArenaAllocator<U>& other) const { return arena == other.arena; }
+    template <typename U>
+    bool operator != (const ArenaAllocator<U>& other) const { return arena != other.arena; }
+
+private:
+    template <typename U> friend class ArenaAllocator;
+    FrameArena* arena;
+};
+
+// Must not outlive the next Reset of its arena, or the ArenaScope it was made in
+template <typename T>
+using ArenaVector = std::vector<T, ArenaAllocator<T>>;
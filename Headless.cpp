@@ -0,0 +1,363 @@
+/*
+	Headless match runner: plays matches on the simulation library without a
+	window, audio device or keyboard and prints one result line per match.
+
+	Build: g++ -std=c++17 -O2 -pthread Simulation.cpp JobSystem.cpp AllocCounter.cpp Headless.cpp -o headless
+	Usage: headless [--matches N] [--seed S] [--script FILE] [--threads N]
+	                [--workers N] [--out FILE] [--alloc-check] [--pool-stats]
+
+	Match m (counted from 0) is played with seed S + m. --workers plays N
+	matches at once, one Game per thread; each Game is reset between its
+	matches and keeps its allocations. Result lines are written to --out
+	(default stdout) as matches finish, so with several workers they are not
+	in match order. --threads instead adds N job system workers to each tick
+	of a single match at a time; the two cannot be combined. Results are the
+	same for any N.
+
+	Without --script the player side is driven by a simple built-in bot
+	whose unit choices and timing come from the match seed, so the matches
+	of a batch play out differently. A script has one command per line,
+	"<tick> spawn <unit>" or "<tick> freeze", with ticks counted from the
+	start of the match (SIM_TICK_RATE ticks per second) and never going
+	down from one command to the next. Lines starting with # are ignored.
+	A script is played as written, so scripted matches only differ in
+	their effects.
+
+	--alloc-check plays the matches one at a time and fails (exit code 2)
+	if anything allocates after the first ALLOC_WARMUP_SECONDS of the run,
+	listing the offending ticks by subsystem. From the second match on the
+	game runs on the storage of the first, so restarts must not allocate
+	either. --pool-stats prints the unit pool's high-water marks, summed
+	over the workers' games, and the largest frame arena peak of any thread.
+*/
+
+#include "Simulation.h"
+#include "JobSystem.h"
+#include "AllocCounter.h"
+#include <algorithm>
+#include <atomic>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <cctype>
+#include <fstream>
+#include <mutex>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+using namespace std;
+
+const int ALLOC_WARMUP_SECONDS = 10;
+const int ALLOC_REPORT_LIMIT = 20; // offending ticks printed per run
+const int BOT_MAX_WAIT_TICKS = SIM_TICK_RATE; // longest the bot hesitates before a spawn
+
+struct ScriptCommand {
+    long long tick;
+    bool freeze;
+    UnitType type;
+};
+
+struct MatchResult {
+    string winner;
+    int playerTowerHP;
+    int enemyTowerHP;
+    float time;
+    long long ticks;
+    int playerUnitsSpawned;
+    int enemyUnitsSpawned;
+};
+
+// Work shared by the batch workers
+struct Batch {
+    int matches;
+    unsigned seed;
+    const vector<ScriptCommand>* script;
+    FILE* out;
+    atomic<int> nextMatch{ 0 };
+
+    mutex resultLock; // guards out and the totals
+    int playerWins = 0;
+    int enemyWins = 0;
+    int draws = 0;
+
+    UnitPoolStats pool;
+    FrameArenaStats arena;
+
+    bool allocCheck = false;
+    long long lateAllocations = 0; // after the warm-up, with --alloc-check
+    long long lateBytes = 0;
+    int lateTicks = 0;
+};
+
+// Parses a script file, rejecting commands out of tick order
+bool LoadScript(const char* path, vector<ScriptCommand>& commands) {
+    ifstream file(path);
+    if (!file) {
+        fprintf(stderr, "cannot open script %s\n", path);
+        return false;
+    }
+
+    string line;
+    int lineNumber = 0;
+    while (getline(file, line)) {
+        lineNumber++;
+        if (line.empty() || line[0] == '#') continue;
+
+        istringstream in(line);
+        ScriptCommand command = { 0, false, UnitType::KNIGHT };
+        string action, unit;
+        if (!(in >> command.tick >> action)) continue;
+
+        if (action == "freeze") {
+            command.freeze = true;
+        } else if (action == "spawn" && in >> unit) {
+            bool found = false;
+            for (int t = 0; t <= (int)UnitType::WIZARD; t++) {
+                string_view name = UNIT_STATS[t].name;
+                if (name.size() == unit.size() &&
+                    equal(name.begin(), name.end(), unit.begin(),
+                          [](char a, char b) { return tolower(a) == tolower(b); })) {
+                    command.type = (UnitType)t;
+                    found = true;
+                }
+            }
+            if (!found) {
+                fprintf(stderr, "%s:%d: unknown unit '%s'\n", path, lineNumber, unit.c_str());
+                return false;
+            }
+        } else {
+            fprintf(stderr, "%s:%d: cannot parse '%s'\n", path, lineNumber, line.c_str());
+            return false;
+        }
+        if (!commands.empty() && command.tick < commands.back().tick) {
+            fprintf(stderr, "%s:%d: tick %lld comes before the previous command's tick %lld\n",
+                    path, lineNumber, command.tick, commands.back().tick);
+            return false;
+        }
+        commands.push_back(command);
+    }
+    return true;
+}
+
+// Built-in player: picks a random unit type, spawns it once elixir allows
+// and up to BOT_MAX_WAIT_TICKS later, and freezes once three enemies are on
+// the field. The choices only depend on the seed.
+struct Bot {
+    SimRandom random;
+    UnitType nextType;
+    int wait; // ticks to hold back once nextType is affordable
+
+    // Consecutive match seeds are spread out first, xorshift output from
+    // nearby seeds starts out alike
+    explicit Bot(unsigned seed) : random(seed * 2654435761u) { PickNext(); }
+
+    void PickNext() {
+        nextType = (UnitType)random.Range(0, (int)UnitType::WIZARD);
+        wait = random.Range(0, BOT_MAX_WAIT_TICKS);
+    }
+};
+
+void RunBot(Game& game, Bot& bot) {
+    if (game.playerElixir >= GetUnitStats(bot.nextType).cost) {
+        if (bot.wait > 0) {
+            bot.wait--;
+        } else {
+            game.SpawnUnit(bot.nextType);
+            bot.PickNext();
+        }
+    }
+
+    if (game.freezeAvailable) {
+        int enemies = 0;
+        for (int i = 0; i < game.units.Count(); i++) {
+            if (!game.units.isPlayer[i] && game.units.isAlive[i]) enemies++;
+        }
+        if (enemies >= 3) game.ActivateFreeze();
+    }
+}
+
+// Counts what was allocated since the last check (the tick, and for the
+// first tick of a match the restart) against the batch, once past the warm-up
+void CheckAllocations(Batch& batch, int match, long long tick) {
+    AllocReport report = TakeAllocReport();
+    if (match == 0 && tick < (long long)ALLOC_WARMUP_SECONDS * SIM_TICK_RATE) return;
+    AllocCount total = report.Total();
+    if (total.allocations == 0) return;
+
+    batch.lateAllocations += total.allocations;
+    batch.lateBytes += total.bytes;
+    if (batch.lateTicks++ >= ALLOC_REPORT_LIMIT) return;
+    fprintf(stderr, "match %d tick %lld: %lld allocations, %lld bytes:", match + 1, tick, total.allocations, total.bytes);
+    for (int t = 0; t < (int)AllocTag::COUNT; t++) {
+        const AllocCount& count = report.tags[t];
+        if (count.allocations > 0) {
+            fprintf(stderr, " %s %lld/%lldB", AllocTagName((AllocTag)t), count.allocations, count.bytes);
+        }
+    }
+    fprintf(stderr, "\n");
+}
+
+MatchResult PlayMatch(Game& game, unsigned seed, const vector<ScriptCommand>* script, Batch* allocCheck, int match) {
+    game.SetSeed(seed);
+    game.Restart();
+
+    // A match ends on its own within GAME_TIME_LIMIT, the cap is a safety net
+    long long maxTicks = (long long)(game.GAME_TIME_LIMIT * SIM_TICK_RATE) + SIM_TICK_RATE;
+    long long tick = 0;
+    size_t nextCommand = 0;
+    Bot bot(seed);
+
+    while (game.currentState == GameState::PLAYING && tick < maxTicks) {
+        if (script) {
+            while (nextCommand < script->size() && (*script)[nextCommand].tick <= tick) {
+                const ScriptCommand& command = (*script)[nextCommand++];
+                if (command.freeze) {
+                    game.ActivateFreeze();
+                } else {
+                    game.SpawnUnit(command.type);
+                }
+            }
+        } else {
+            RunBot(game, bot);
+        }
+        game.Update(SIM_DT);
+        if (allocCheck) CheckAllocations(*allocCheck, match, tick);
+        tick++;
+    }
+
+    MatchResult result;
+    result.winner = game.winner.empty() ? "Unfinished" : game.winner;
+    result.playerTowerHP = game.playerTower.currentHP;
+    result.enemyTowerHP = game.enemyTower.currentHP;
+    result.time = game.GAME_TIME_LIMIT - game.gameTimer;
+    result.ticks = tick;
+    result.playerUnitsSpawned = game.playerUnitsSpawned;
+    result.enemyUnitsSpawned = game.enemyUnitsSpawned;
+    return result;
+}
+
+// Takes matches off the batch until none are left, playing them all on one game
+void RunWorker(Batch& batch, JobSystem* jobs) {
+    Game game;
+    game.SetJobSystem(jobs);
+
+    for (;;) {
+        int m = batch.nextMatch.fetch_add(1);
+        if (m >= batch.matches) break;
+
+        MatchResult result = PlayMatch(game, batch.seed + m, batch.script, batch.allocCheck ? &batch : nullptr, m);
+
+        lock_guard<mutex> guard(batch.resultLock);
+        fprintf(batch.out, "match %d: winner=\"%s\" playerTower=%d enemyTower=%d time=%.2fs ticks=%lld "
+                "playerSpawned=%d enemySpawned=%d\n",
+                m + 1, result.winner.c_str(), result.playerTowerHP, result.enemyTowerHP,
+                result.time, result.ticks, result.playerUnitsSpawned, result.enemyUnitsSpawned);
+
+        if (result.winner == "Player Wins!") batch.playerWins++;
+        else if (result.winner == "Enemy Wins!") batch.enemyWins++;
+        else batch.draws++;
+    }
+
+    UnitPoolStats pool = game.units.PoolStats();
+    lock_guard<mutex> guard(batch.resultLock);
+    batch.pool.capacity += pool.capacity;
+    batch.pool.peakUnits = max(batch.pool.peakUnits, pool.peakUnits);
+    batch.pool.ids += pool.ids;
+    batch.pool.spawns += pool.spawns;
+    batch.pool.reusedIds += pool.reusedIds;
+    batch.pool.growths += pool.growths;
+    FrameArenaStats arena = game.ArenaStats();
+    batch.arena.capacity = max(batch.arena.capacity, arena.capacity);
+    batch.arena.peak = max(batch.arena.peak, arena.peak);
+    batch.arena.overflows += arena.overflows;
+}
+
+int main(int argc, char** argv) {
+    int matches = 1;
+    unsigned seed = 1;
+    const char* scriptPath = nullptr;
+    const char* outPath = nullptr;
+    int threads = 0;
+    int workers = 1;
+    bool allocCheck = false;
+    bool poolStats = false;
+
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--matches") == 0 && i + 1 < argc) {
+            matches = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--seed") == 0 && i + 1 < argc) {
+            seed = (unsigned)strtoul(argv[++i], nullptr, 10);
+        } else if (strcmp(argv[i], "--script") == 0 && i + 1 < argc) {
+            scriptPath = argv[++i];
+        } else if (strcmp(argv[i], "--threads") == 0 && i + 1 < argc) {
+            threads = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--workers") == 0 && i + 1 < argc) {
+            workers = max(atoi(argv[++i]), 1);
+        } else if (strcmp(argv[i], "--out") == 0 && i + 1 < argc) {
+            outPath = argv[++i];
+        } else if (strcmp(argv[i], "--alloc-check") == 0) {
+            allocCheck = true;
+        } else if (strcmp(argv[i], "--pool-stats") == 0) {
+            poolStats = true;
+        } else {
+            fprintf(stderr, "usage: %s [--matches N] [--seed S] [--script FILE] [--threads N] "
+                    "[--workers N] [--out FILE] [--alloc-check] [--pool-stats]\n", argv[0]);
+            return 1;
+        }
+    }
+    if (threads > 0 && workers > 1) {
+        fprintf(stderr, "--threads and --workers cannot be combined\n");
+        return 1;
+    }
+    if (allocCheck && workers > 1) {
+        fprintf(stderr, "--alloc-check and --workers cannot be combined\n");
+        return 1;
+    }
+
+    vector<ScriptCommand> script;
+    if (scriptPath && !LoadScript(scriptPath, script)) return 1;
+
+    FILE* out = outPath ? fopen(outPath, "w") : stdout;
+    if (!out) {
+        fprintf(stderr, "cannot open %s\n", outPath);
+        return 1;
+    }
+
+    Batch batch;
+    batch.matches = matches;
+    batch.seed = seed;
+    batch.script = scriptPath ? &script : nullptr;
+    batch.out = out;
+    batch.allocCheck = allocCheck;
+
+    if (workers == 1) {
+        JobSystem jobs(threads);
+        RunWorker(batch, &jobs);
+    } else {
+        vector<thread> pool;
+        for (int w = 0; w < workers; w++) {
+            pool.emplace_back(RunWorker, ref(batch), nullptr);
+        }
+        for (auto& worker : pool) {
+            worker.join();
+        }
+    }
+
+    if (out != stdout) fclose(out);
+    printf("total: %d matches, player %d, enemy %d, draw %d\n",
+           matches, batch.playerWins, batch.enemyWins, batch.draws);
+    if (poolStats) {
+        printf("unit pool: capacity %d, peak %d units, %d ids, %lld spawns (%lld reused ids), grew %d times\n",
+               batch.pool.capacity, batch.pool.peakUnits, batch.pool.ids,
+               batch.pool.spawns, batch.pool.reusedIds, batch.pool.growths);
+        printf("frame arena: peak %zu of %zu bytes, %lld overflows\n",
+               batch.arena.peak, batch.arena.capacity, batch.arena.overflows);
+    }
+    if (allocCheck) {
+        printf("alloc check: %d ticks allocated after the warm-up, %lld allocations, %lld bytes\n",
+               batch.lateTicks, batch.lateAllocations, batch.lateBytes);
+        if (batch.lateAllocations > 0) return 2;
+    }
+    return 0;
+}
@@ -0,0 +1,150 @@
+#include "JobSystem.h"
+#include <algorithm>
+using namespace std;
+
+JobSystem::JobSystem(int workerCount) : queues(max(workerCount, 0) + 1) {
+    for (int t = 1; t <= workerCount; t++) {
+        workers.emplace_back(&JobSystem::WorkerLoop, this, t);
+    }
+}
+
+JobSystem::~JobSystem() {
+    {
+        lock_guard<mutex> guard(wakeLock);
+        stopping = true;
+    }
+    wake.notify_all();
+    for (auto& worker : workers) {
+        worker.join();
+    }
+}
+
+int JobSystem::DefaultWorkerCount() {
+    int hardware = (int)thread::hardware_concurrency();
+    return max(hardware - 1, 0);
+}
+
+void JobSystem::ParallelFor(int count, int minGrain, const RangeBody& rangeBody) {
+    if (count <= 0) return;
+    minGrain = max(minGrain, 1);
+    if (workers.empty() || count <= minGrain) {
+        rangeBody(0, count, 0);
+        return;
+    }
+
+    // About four chunks per thread before stealing starts, so a thread that
+    // finishes early still finds something to take
+    int threads = ThreadCount();
+    grain = max(minGrain, count / (threads * 4));
+
+    // Every thread starts on its own contiguous share
+    for (int t = 0; t < threads; t++) {
+        int begin = (int)((long long)count * t / threads);
+        int end = (int)((long long)count * (t + 1) / threads);
+        if (begin == end) continue;
+        lock_guard<mutex> guard(queues[t].lock);
+        queues[t].PushBack({ begin, end });
+    }
+
+    body = &rangeBody;
+    remaining.store(count);
+    activeWorkers.store(WorkerCount());
+    {
+        lock_guard<mutex> guard(wakeLock);
+        jobGeneration++;
+    }
+    wake.notify_all();
+
+    RunUntilDone(0);
+
+    // Workers still hold body until they report back
+    while (activeWorkers.load() > 0) {
+        this_thread::yield();
+    }
+    body = nullptr;
+}
+
+void JobSystem::WorkerLoop(int threadIndex) {
+    unsigned seen = 0;
+    for (;;) {
+        {
+            unique_lock<mutex> guard(wakeLock);
+            wake.wait(guard, [&] { return stopping || jobGeneration != seen; });
+            if (stopping) return;
+            seen = jobGeneration;
+        }
+        RunUntilDone(threadIndex);
+        activeWorkers.fetch_sub(1);
+    }
+}
+
+void JobSystem::RunUntilDone(int threadIndex) {
+    Range range;
+    while (remaining.load() > 0) {
+        if (!PopOrSteal(threadIndex, range)) {
+            this_thread::yield();
+            continue;
+        }
+
+        // Keep one grain and leave the rest where others can steal it
+        while (range.end - range.begin > grain) {
+            int mid = range.begin + (range.end - range.begin) / 2;
+            {
+                lock_guard<mutex> guard(queues[threadIndex].lock);
+                queues[threadIndex].PushBack({ mid, range.end });
+            }
+            range.end = mid;
+        }
+
+        (*body)(range.begin, range.end, threadIndex);
+        remaining.fetch_sub(range.end - range.begin);
+    }
+}
+
+bool JobSystem::PopOrSteal(int threadIndex, Range& range) {
+    {
+        WorkQueue& own = queues[threadIndex];
+        lock_guard<mutex> guard(own.lock);
+        if (own.PopBack(range)) return true;
+    }
+
+    int threads = (int)queues.size();
+    for (int k = 1; k < threads; k++) {
+        WorkQueue& victim = queues[(threadIndex + k) % threads];
+        lock_guard<mutex> guard(victim.lock);
+        if (victim.PopFront(range)) return true;
+    }
+    return false;
+}
+
+// Callers hold lock
+void JobSystem::WorkQueue::PushBack(Range range) {
+    unsigned size = (unsigned)ring.size();
+    if (count == size) {
+        // Unroll into a ring twice the size
+        vector<Range> grown(size * 2);
+        for (unsigned k = 0; k < count; k++) {
+            grown[k] = ring[(head + k) & (size - 1)];
+        }
+        ring.swap(grown);
+        head = 0;
+        size *= 2;
+    }
+    ring[(head + count) & (size - 1)] = range;
+    count++;
+}
+
+bool JobSystem::WorkQueue::PopBack(Range& range) {
+    if (count == 0) return false;
+    count--;
+    range = ring[(head + count) & (ring.size() - 1)];
+    return true;
+}
+
+bool JobSystem::WorkQueue::PopFront(Range& range) {
+    if (count == 0) return false;
+    range = ring[head];
+    head = (head + 1) & (ring.size() - 1);
+    count--;
+    return true;
+}
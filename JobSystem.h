@@ -0,0 +1,76 @@
+/*
+	Work-stealing job system for the per-tick simulation phases.
+	ParallelFor splits an index range into chunks, hands each thread a share
+	in its own deque and lets idle threads steal from the others. The calling
+	thread works through the range too and returns once all of it is done.
+*/
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+class JobSystem {
+public:
+    // body(begin, end, threadIndex) handles indices [begin, end). threadIndex
+    // is 0 for the calling thread and 1..WorkerCount() for the workers, so it
+    // can pick a per-thread scratch buffer.
+    using RangeBody = std::function<void(int begin, int end, int threadIndex)>;
+
+    // workerCount threads besides the caller; 0 runs every job inline
+    explicit JobSystem(int workerCount = DefaultWorkerCount());
+    ~JobSystem();
+    JobSystem(const JobSystem&) = delete;
+    JobSystem& operator = (const JobSystem&) = delete;
+
+    // One worker per hardware thread, minus the caller
+    static int DefaultWorkerCount();
+
+    int WorkerCount() const { return (int)workers.size(); }
+    int ThreadCount() const { return (int)workers.size() + 1; }
+
+    // Runs body over [0, count). Chunks are never smaller than minGrain and
+    // shrink with the range so every thread gets several to balance with.
+    // Not reentrant: body must not call ParallelFor.
+    void ParallelFor(int count, int minGrain, const RangeBody& body);
+
+private:
+    struct Range {
+        int begin;
+        int end;
+    };
+
+    // One per thread. The owner pops from the back, thieves take the front.
+    // A ring that only grows, unlike std::deque, which frees and reallocates
+    // blocks as ranges come and go.
+    struct WorkQueue {
+        std::mutex lock;
+        std::vector<Range> ring = std::vector<Range>(16); // size is a power of two
+        unsigned head = 0; // front
+        unsigned count = 0;
+
+        void PushBack(Range range);
+        bool PopBack(Range& range);
+        bool PopFront(Range& range);
+    };
+
+    std::vector<std::thread> workers;
+    std::vector<WorkQueue> queues; // [0] is the calling thread's
+
+    std::mutex wakeLock;
+    std::condition_variable wake;
+    unsigned jobGeneration = 0; // bumped for every ParallelFor
+    bool stopping = false;
+
+    const RangeBody* body = nullptr;
+    int grain = 1;
+    std::atomic<int> remaining{ 0 }; // indices not yet processed
+    std::atomic<int> activeWorkers{ 0 };
+
+    void WorkerLoop(int threadIndex);
+    void RunUntilDone(int threadIndex);
+    bool PopOrSteal(int threadIndex, Range& range);
+};
@@ -0,0 +1,73 @@
+#include "MusicThread.h"
+#include "raylib.h"
+#include <chrono>
+using namespace std;
+
+const int MUSIC_SAMPLE_RATE = 44100; // for sizing the stream buffers, other rates just buffer longer or shorter
+const int REFILL_MS = 10;            // music thread sleep between buffer top-ups
+
+MusicThread::MusicThread(const string& file) : fileName(file) {}
+
+MusicThread::~MusicThread() {
+    Stop();
+}
+
+void MusicThread::Start() {
+    if (running.load()) return;
+    running.store(true);
+    thread = std::thread(&MusicThread::Run, this);
+}
+
+void MusicThread::Stop() {
+    if (!running.exchange(false)) return;
+    thread.join();
+}
+
+void MusicThread::Run() {
+    // Stream buffers that last BUFFER_MS. The size is a raylib-wide default,
+    // so it goes straight back once the stream exists.
+    SetAudioStreamBufferSizeDefault(MUSIC_SAMPLE_RATE * BUFFER_MS / 1000);
+    Music music = LoadMusicStream(fileName.c_str());
+    SetAudioStreamBufferSizeDefault(0);
+    // A missing or broken file just means no music
+    if (music.frameCount == 0) return;
+
+    // Looped here rather than by raylib, so a track that ends without
+    // playing anything stops instead of restarting forever
+    music.looping = false;
+    bool started = false;        // PlayMusicStream was called
+    bool streamPlaying = false;
+    bool played = false;         // time went by since the track last started
+    float streamVolume = -1.0f;
+
+    while (running.load()) {
+        float v = volume.load();
+        if (v != streamVolume) {
+            SetMusicVolume(music, v);
+            streamVolume = v;
+        }
+        bool p = playing.load();
+        if (p != streamPlaying) {
+            if (!p) PauseMusicStream(music);
+            else if (started) ResumeMusicStream(music);
+            else PlayMusicStream(music);
+            started = true;
+            streamPlaying = p;
+        }
+
+        if (streamPlaying) {
+            UpdateMusicStream(music);
+            if (GetMusicTimePlayed(music) > 0.0f) played = true;
+            if (!IsMusicStreamPlaying(music)) {
+                // End of the track, raylib has rewound it already
+                if (!played) break;
+                played = false;
+                PlayMusicStream(music);
+            }
+        }
+
+        this_thread::sleep_for(chrono::milliseconds(REFILL_MS));
+    }
+
+    UnloadMusicStream(music);
+}
@@ -0,0 +1,39 @@
+/*
+	Background music on its own thread. The music thread owns the raylib
+	music stream and tops its buffers up every few ms, so a slow frame on
+	the window thread can no longer starve the music. The window thread
+	only sends play, pause and volume changes.
+*/
+#pragma once
+
+#include <atomic>
+#include <string>
+#include <thread>
+
+class MusicThread {
+public:
+    static const int BUFFER_MS = 250; // a music thread stall this long is still gapless
+
+    explicit MusicThread(const std::string& fileName);
+    ~MusicThread();
+    MusicThread(const MusicThread&) = delete;
+    MusicThread& operator = (const MusicThread&) = delete;
+
+    // The audio device has to be open by now
+    void Start();
+    void Stop();
+
+    // Window thread side, picked up by the music thread within a few ms
+    void Play() { playing.store(true); }
+    void Pause() { playing.store(false); }
+    void SetVolume(float v) { volume.store(v); }
+
+private:
+    std::string fileName;
+    std::thread thread;
+    std::atomic<bool> running{ false };
+    std::atomic<bool> playing{ false };
+    std::atomic<float> volume{ 1.0f };
+
+    void Run();
+};
@@ -0,0 +1,118 @@
+#include "SimThread.h"
+#include <chrono>
+using namespace std;
+
+bool InputQueue::Push(const InputCommand& command) {
+    unsigned t = tail.load(memory_order_relaxed);
+    if (t - head.load(memory_order_acquire) == CAPACITY) return false;
+    items[t % CAPACITY] = command;
+    tail.store(t + 1, memory_order_release);
+    return true;
+}
+
+bool InputQueue::Pop(InputCommand& command) {
+    unsigned h = head.load(memory_order_relaxed);
+    if (h == tail.load(memory_order_acquire)) return false;
+    command = items[h % CAPACITY];
+    head.store(h + 1, memory_order_release);
+    return true;
+}
+
+void SnapshotBuffer::Reserve(int units, int projectiles) {
+    for (RenderSnapshot& slot : slots) {
+        slot.units.reserve(units);
+        slot.projectiles.reserve(projectiles);
+    }
+}
+
+void SnapshotBuffer::Publish() {
+    int previous = middle.exchange(writeIndex | FRESH, memory_order_acq_rel);
+    writeIndex = previous & ~FRESH;
+}
+
+const RenderSnapshot& SnapshotBuffer::Latest() {
+    if (middle.load(memory_order_relaxed) & FRESH) {
+        int previous = middle.exchange(readIndex, memory_order_acq_rel);
+        readIndex = previous & ~FRESH;
+    }
+    return slots[readIndex];
+}
+
+SimThread::SimThread(Game& g) : game(g) {
+    snapshots.Reserve(UNIT_RESERVE, PROJECTILE_CAPACITY);
+}
+
+SimThread::~SimThread() {
+    Stop();
+}
+
+void SimThread::Start() {
+    if (running.load()) return;
+
+    // The render thread has something to draw from the first frame
+    PublishSnapshot();
+    running.store(true);
+    thread = std::thread(&SimThread::Run, this);
+}
+
+void SimThread::Stop() {
+    if (!running.exchange(false)) return;
+    thread.join();
+}
+
+void SimThread::Send(const InputCommand& command) {
+    // A full queue means the simulation is far behind; dropping a key press is fine
+    input.Push(command);
+}
+
+void SimThread::Run() {
+    auto last = chrono::steady_clock::now();
+    while (running.load()) {
+        bool changed = false;
+        InputCommand command;
+        while (input.Pop(command)) {
+            Apply(command);
+            changed = true;
+        }
+
+        auto now = chrono::steady_clock::now();
+        float frameTime = chrono::duration<float>(now - last).count();
+        last = now;
+        int steps = clock.Advance(frameTime);
+        for (int i = 0; i < steps; i++) {
+            game.Update(SIM_DT);
+        }
+
+        if (steps > 0 || changed) {
+            PublishSnapshot();
+        }
+
+        // Sleep until the next tick is due
+        double wait = SIM_DT - clock.accumulator;
+        if (wait > 0.0) {
+            this_thread::sleep_for(chrono::duration<double>(wait));
+        }
+    }
+}
+
+void SimThread::Apply(const InputCommand& command) {
+    switch (command.kind) {
+        case InputCommand::Kind::SPAWN:
+            game.SpawnUnit(command.unit);
+            break;
+        case InputCommand::Kind::FREEZE:
+            game.ActivateFreeze();
+            break;
+        case InputCommand::Kind::START:
+            if (game.currentState == GameState::START_SCREEN) game.Start();
+            break;
+        case InputCommand::Kind::RESTART:
+            if (game.currentState == GameState::GAME_OVER) game.Restart();
+            break;
+    }
+}
+
+void SimThread::PublishSnapshot() {
+    game.WriteSnapshot(snapshots.WriteSlot(), clock.tick);
+    snapshots.Publish();
+}
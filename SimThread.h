@@ -0,0 +1,90 @@
+/*
+	Runs a Game on its own thread at the fixed tick rate. The render thread
+	sends input through an InputQueue and draws the latest RenderSnapshot
+	from a SnapshotBuffer; neither side ever waits for the other.
+*/
+#pragma once
+
+#include "Simulation.h"
+#include <atomic>
+#include <thread>
+
+struct InputCommand {
+    enum class Kind : unsigned char {
+        SPAWN,
+        FREEZE,
+        START,
+        RESTART
+    };
+
+    Kind kind;
+    UnitType unit; // SPAWN only
+};
+
+// Single producer, single consumer ring of input commands
+class InputQueue {
+public:
+    static const unsigned CAPACITY = 64; // power of two
+
+    // Producer side, false if the queue is full
+    bool Push(const InputCommand& command);
+    // Consumer side, false if the queue is empty
+    bool Pop(InputCommand& command);
+
+private:
+    InputCommand items[CAPACITY];
+    std::atomic<unsigned> head{ 0 }; // next to pop
+    std::atomic<unsigned> tail{ 0 }; // next to push
+};
+
+// Lock-free triple buffer. The writer fills WriteSlot and publishes it, the
+// reader picks up the newest published snapshot; each owns one slot and the
+// third is swapped between them.
+class SnapshotBuffer {
+public:
+    // Room for this many units and projectiles in every slot
+    void Reserve(int units, int projectiles);
+
+    // Writer side
+    RenderSnapshot& WriteSlot() { return slots[writeIndex]; }
+    void Publish();
+
+    // Reader side. Stays valid until the next call.
+    const RenderSnapshot& Latest();
+
+private:
+    static const int FRESH = 4; // set on middle when it holds an unread snapshot
+
+    RenderSnapshot slots[3];
+    int writeIndex = 0;
+    int readIndex = 1;
+    std::atomic<int> middle{ 2 };
+};
+
+class SimThread {
+public:
+    // game must outlive the SimThread and is not touched by the caller while running
+    explicit SimThread(Game& game);
+    ~SimThread();
+    SimThread(const SimThread&) = delete;
+    SimThread& operator = (const SimThread&) = delete;
+
+    void Start();
+    void Stop();
+
+    // Render thread side
+    void Send(const InputCommand& command);
+    const RenderSnapshot& LatestSnapshot() { return snapshots.Latest(); }
+
+private:
+    Game& game;
+    SimClock clock;
+    InputQueue input;
+    SnapshotBuffer snapshots;
+    std::thread thread;
+    std::atomic<bool> running{ false };
+
+    void Run();
+    void Apply(const InputCommand& command);
+    void PublishSnapshot();
+};
@@ -0,0 +1,141 @@
+/*
+	Small float SIMD wrapper for the simulation kernels.
+	FloatLanes is the widest vector the build targets: 16 lanes with
+	AVX-512F, 8 with AVX, 4 with SSE2 (always there on x86-64). ScalarLanes
+	runs the same operations one float at a time. A kernel written once as a
+	template over the lane type gives bit-identical results with either,
+	because every operation is a single correctly rounded IEEE float op (no
+	reciprocal or rsqrt approximations). Define SIM_SCALAR to build without
+	intrinsics; build with -ffp-contract=off if the compiler may use FMA.
+*/
+#pragma once
+
+#include <cmath>
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+
+#if !defined(SIM_SCALAR) && (defined(__AVX512F__) || defined(__AVX__) || defined(__SSE2__) || defined(_M_X64))
+#include <immintrin.h>
+#define SIM_SIMD 1
+#endif
+
+// Index of the lowest set bit, bits must not be 0
+inline int CountTrailingZeros(unsigned bits) {
+#if defined(_MSC_VER)
+    unsigned long index;
+    _BitScanForward(&index, bits);
+    return (int)index;
+#else
+    return __builtin_ctz(bits);
+#endif
+}
+
+struct ScalarLanes {
+    static const int WIDTH = 1;
+    float v;
+
+    static ScalarLanes Load(const float* p) { return { *p }; }
+    static ScalarLanes Set1(float x) { return { x }; }
+    void Store(float* p) const { *p = v; }
+};
+struct ScalarMask {
+    bool m;
+};
+
+inline ScalarLanes operator + (ScalarLanes a, ScalarLanes b) { return { a.v + b.v }; }
+inline ScalarLanes operator - (ScalarLanes a, ScalarLanes b) { return { a.v - b.v }; }
+inline ScalarLanes operator * (ScalarLanes a, ScalarLanes b) { return { a.v * b.v }; }
+inline ScalarLanes operator / (ScalarLanes a, ScalarLanes b) { return { a.v / b.v }; }
+inline ScalarLanes Sqrt(ScalarLanes a) { return { std::sqrt(a.v) }; }
+inline ScalarMask Less(ScalarLanes a, ScalarLanes b) { return { a.v < b.v }; }
+inline ScalarMask LessEqual(ScalarLanes a, ScalarLanes b) { return { a.v <= b.v }; }
+inline ScalarMask operator & (ScalarMask a, ScalarMask b) { return { a.m && b.m }; }
+inline ScalarLanes Select(ScalarMask mask, ScalarLanes ifTrue, ScalarLanes ifFalse) { return mask.m ? ifTrue : ifFalse; }
+// One bit per lane, lane 0 in bit 0
+inline unsigned Bits(ScalarMask mask) { return mask.m ? 1u : 0u; }
+
+#if defined(SIM_SIMD) && defined(__AVX512F__)
+
+struct FloatLanes {
+    static const int WIDTH = 16;
+    __m512 v;
+
+    static FloatLanes Load(const float* p) { return { _mm512_loadu_ps(p) }; }
+    static FloatLanes Set1(float x) { return { _mm512_set1_ps(x) }; }
+    void Store(float* p) const { _mm512_storeu_ps(p, v); }
+};
+struct LaneMask {
+    __mmask16 m;
+};
+
+inline FloatLanes operator + (FloatLanes a, FloatLanes b) { return { _mm512_add_ps(a.v, b.v) }; }
+inline FloatLanes operator - (FloatLanes a, FloatLanes b) { return { _mm512_sub_ps(a.v, b.v) }; }
+inline FloatLanes operator * (FloatLanes a, FloatLanes b) { return { _mm512_mul_ps(a.v, b.v) }; }
+inline FloatLanes operator / (FloatLanes a, FloatLanes b) { return { _mm512_div_ps(a.v, b.v) }; }
+inline FloatLanes Sqrt(FloatLanes a) { return { _mm512_sqrt_ps(a.v) }; }
+inline LaneMask Less(FloatLanes a, FloatLanes b) { return { _mm512_cmp_ps_mask(a.v, b.v, _CMP_LT_OQ) }; }
+inline LaneMask LessEqual(FloatLanes a, FloatLanes b) { return { _mm512_cmp_ps_mask(a.v, b.v, _CMP_LE_OQ) }; }
+inline LaneMask operator & (LaneMask a, LaneMask b) { return { (__mmask16)(a.m & b.m) }; }
+inline FloatLanes Select(LaneMask mask, FloatLanes ifTrue, FloatLanes ifFalse) { return { _mm512_mask_blend_ps(mask.m, ifFalse.v, ifTrue.v) }; }
+inline unsigned Bits(LaneMask mask) { return (unsigned)mask.m; }
+
+#elif defined(SIM_SIMD) && defined(__AVX__)
+
+struct FloatLanes {
+    static const int WIDTH = 8;
+    __m256 v;
+
+    static FloatLanes Load(const float* p) { return { _mm256_loadu_ps(p) }; }
+    static FloatLanes Set1(float x) { return { _mm256_set1_ps(x) }; }
+    void Store(float* p) const { _mm256_storeu_ps(p, v); }
+};
+struct LaneMask {
+    __m256 m;
+};
+
+inline FloatLanes operator + (FloatLanes a, FloatLanes b) { return { _mm256_add_ps(a.v, b.v) }; }
+inline FloatLanes operator - (FloatLanes a, FloatLanes b) { return { _mm256_sub_ps(a.v, b.v) }; }
+inline FloatLanes operator * (FloatLanes a, FloatLanes b) { return { _mm256_mul_ps(a.v, b.v) }; }
+inline FloatLanes operator / (FloatLanes a, FloatLanes b) { return { _mm256_div_ps(a.v, b.v) }; }
+inline FloatLanes Sqrt(FloatLanes a) { return { _mm256_sqrt_ps(a.v) }; }
+inline LaneMask Less(FloatLanes a, FloatLanes b) { return { _mm256_cmp_ps(a.v, b.v, _CMP_LT_OQ) }; }
+inline LaneMask LessEqual(FloatLanes a, FloatLanes b) { return { _mm256_cmp_ps(a.v, b.v, _CMP_LE_OQ) }; }
+inline LaneMask operator & (LaneMask a, LaneMask b) { return { _mm256_and_ps(a.m, b.m) }; }
+inline FloatLanes Select(LaneMask mask, FloatLanes ifTrue, FloatLanes ifFalse) { return { _mm256_blendv_ps(ifFalse.v, ifTrue.v, mask.m) }; }
+inline unsigned Bits(LaneMask mask) { return (unsigned)_mm256_movemask_ps(mask.m); }
+
+#elif defined(SIM_SIMD)
+
+struct FloatLanes {
+    static const int WIDTH = 4;
+    __m128 v;
+
+    static FloatLanes Load(const float* p) { return { _mm_loadu_ps(p) }; }
+    static FloatLanes Set1(float x) { return { _mm_set1_ps(x) }; }
+    void Store(float* p) const { _mm_storeu_ps(p, v); }
+};
+struct LaneMask {
+    __m128 m;
+};
+
+inline FloatLanes operator + (FloatLanes a, FloatLanes b) { return { _mm_add_ps(a.v, b.v) }; }
+inline FloatLanes operator - (FloatLanes a, FloatLanes b) { return { _mm_sub_ps(a.v, b.v) }; }
+inline FloatLanes operator * (FloatLanes a, FloatLanes b) { return { _mm_mul_ps(a.v, b.v) }; }
+inline FloatLanes operator / (FloatLanes a, FloatLanes b) { return { _mm_div_ps(a.v, b.v) }; }
+inline FloatLanes Sqrt(FloatLanes a) { return { _mm_sqrt_ps(a.v) }; }
+inline LaneMask Less(FloatLanes a, FloatLanes b) { return { _mm_cmplt_ps(a.v, b.v) }; }
+inline LaneMask LessEqual(FloatLanes a, FloatLanes b) { return { _mm_cmple_ps(a.v, b.v) }; }
+inline LaneMask operator & (LaneMask a, LaneMask b) { return { _mm_and_ps(a.m, b.m) }; }
+// SSE2 has no blendv
+inline FloatLanes Select(LaneMask mask, FloatLanes ifTrue, FloatLanes ifFalse) {
+    return { _mm_or_ps(_mm_and_ps(mask.m, ifTrue.v), _mm_andnot_ps(mask.m, ifFalse.v)) };
+}
+inline unsigned Bits(LaneMask mask) { return (unsigned)_mm_movemask_ps(mask.m); }
+
+#else
+
+using FloatLanes = ScalarLanes;
+using LaneMask = ScalarMask;
+
+#endif
@@ -0,0 +1,1243 @@
+#include "Simulation.h"
+#include "JobSystem.h"
+#include "Simd.h"
+#include "AllocCounter.h"
+#include <algorithm>
+#include <cmath>
+using namespace std;
+
+// Range filter radii are widened by this much so float rounding in the
+// squared-distance prefilter never drops a unit the exact check would keep
+const float RANGE_FILTER_MARGIN = 1.0f;
+
+// Smallest chunk of units / projectiles handed to one job system thread
+const int UNIT_GRAIN = 64;
+const int PROJECTILE_GRAIN = 512;
+
+// Where units spawn, in front of their own tower
+const float PLAYER_SPAWN_X = 150.0f;
+const float ENEMY_SPAWN_X = (float)SCREEN_WIDTH - 150.0f;
+
+int PathTable::Intern(int startX, bool player) {
+    for (int r = 0; r < (int)routes.size(); r++) {
+        if (routes[r].startX == startX && routes[r].player == player) return r;
+    }
+    
+    Route route = { startX, player, {} };
+    route.waypoints.reserve(SCREEN_WIDTH / 50);
+    if (player) {
+        // Player units movs toward enemy tower
+        for (int x = startX; x < SCREEN_WIDTH - 50; x += 50) {
+            route.waypoints.push_back({(float)x, LANE_Y});
+        }
+    } else {
+        // Enemy units moves toward player tower
+        for (int x = startX; x > 50; x -= 50) {
+            route.waypoints.push_back({(float)x, LANE_Y});
+        }
+    }
+    routes.push_back(move(route));
+    return (int)routes.size() - 1;
+}
+
+UnitHandle UnitStore::Spawn(UnitType unitType, bool player) {
+    AllocScope allocTag(AllocTag::UNITS);
+    // Every array grows at once, and only when the store is full
+    if (Count() == (int)posX.capacity()) {
+        Reserve(max(Count() * 2, 16));
+        poolStats.growths++;
+    }
+    poolStats.spawns++;
+    poolStats.peakUnits = max(poolStats.peakUnits, Count() + 1);
+
+    int id;
+    if (!freeIds.empty()) {
+        id = freeIds.back();
+        freeIds.pop_back();
+        poolStats.reusedIds++;
+    } else {
+        id = (int)idToIndex.size();
+        idToIndex.push_back(-1);
+        generations.push_back(0);
+    }
+    int index = Count();
+    idToIndex[id] = index;
+    indexToId.push_back(id);
+    pendingLaneIds.push_back(id);
+
+    type.push_back(unitType);
+    isPlayer.push_back(player);
+    isAlive.push_back(true);
+    target.push_back(UnitHandle());
+    inTowerRange.push_back(false);
+    isFrozen.push_back(false);
+    freezeTimer.push_back(0.0f);
+    currentHP.push_back(GetUnitStats(unitType).hp);
+    attackTimer.push_back(0.0f);
+    
+    //Initial position of player and enemy tower
+    if (player) {
+        posX.push_back(PLAYER_SPAWN_X);
+    } else {
+        posX.push_back(ENEMY_SPAWN_X);
+    }
+    posY.push_back(LANE_Y);
+    routeId.push_back(-1);
+    pathCursor.push_back(0);
+    
+    generatePath(index);
+    return { id, generations[id] };
+}
+
+// Swap-and-pop: the last unit moves into the removed slot
+void UnitStore::Remove(int index) {
+    // Moves a unit to a new dense index
+    lanes[0].current = false;
+    lanes[1].current = false;
+    
+    int last = Count() - 1;
+    int removedId = indexToId[index];
+    if (index != last) {
+        int movedId = indexToId[last];
+        posX[index] = posX[last];
+        posY[index] = posY[last];
+        currentHP[index] = currentHP[last];
+        attackTimer[index] = attackTimer[last];
+        freezeTimer[index] = freezeTimer[last];
+        isPlayer[index] = isPlayer[last];
+        isAlive[index] = isAlive[last];
+        isFrozen[index] = isFrozen[last];
+        target[index] = target[last];
+        inTowerRange[index] = inTowerRange[last];
+        type[index] = type[last];
+        routeId[index] = routeId[last];
+        pathCursor[index] = pathCursor[last];
+        indexToId[index] = movedId;
+        idToIndex[movedId] = index;
+    }
+    posX.pop_back();
+    posY.pop_back();
+    currentHP.pop_back();
+    attackTimer.pop_back();
+    freezeTimer.pop_back();
+    isPlayer.pop_back();
+    isAlive.pop_back();
+    isFrozen.pop_back();
+    target.pop_back();
+    inTowerRange.pop_back();
+    type.pop_back();
+    routeId.pop_back();
+    pathCursor.pop_back();
+    indexToId.pop_back();
+    idToIndex[removedId] = -1;
+    generations[removedId]++;
+    retiredIds.push_back(removedId);
+}
+
+void UnitStore::Reserve(int count) {
+    posX.reserve(count);
+    posY.reserve(count);
+    currentHP.reserve(count);
+    attackTimer.reserve(count);
+    freezeTimer.reserve(count);
+    isPlayer.reserve(count);
+    isAlive.reserve(count);
+    isFrozen.reserve(count);
+    target.reserve(count);
+    inTowerRange.reserve(count);
+    type.reserve(count);
+    routeId.reserve(count);
+    pathCursor.reserve(count);
+    idToIndex.reserve(count);
+    generations.reserve(count);
+    indexToId.reserve(count);
+    freeIds.reserve(count);
+    retiredIds.reserve(count);
+    pendingLaneIds.reserve(count);
+    lanes[0].reserve(count);
+    lanes[1].reserve(count);
+    nextX.reserve(count);
+    nextY.reserve(count);
+    mergedDamage.reserve(count * 4);
+
+    // Build both spawn routes now rather than on the first spawn of each side
+    paths.Intern((int)PLAYER_SPAWN_X, true);
+    paths.Intern((int)ENEMY_SPAWN_X, false);
+}
+
+UnitPoolStats UnitStore::PoolStats() const {
+    UnitPoolStats stats = poolStats;
+    stats.capacity = (int)posX.capacity();
+    stats.ids = (int)idToIndex.size();
+    return stats;
+}
+
+// Empties the store but keeps the capacity of every array. Slot generations
+// are kept too, so handles from before the clear stay stale.
+void UnitStore::Clear() {
+    for (int id : indexToId) {
+        idToIndex[id] = -1;
+        generations[id]++;
+    }
+    // Every id is free again. They go out lowest first, like in a new store,
+    // so the ids of a match (and the tie-breaks on them) do not depend on
+    // the matches played before it.
+    freeIds.clear();
+    for (int id = (int)idToIndex.size() - 1; id >= 0; id--) {
+        freeIds.push_back(id);
+    }
+
+    posX.clear();
+    posY.clear();
+    currentHP.clear();
+    attackTimer.clear();
+    freezeTimer.clear();
+    isPlayer.clear();
+    isAlive.clear();
+    isFrozen.clear();
+    target.clear();
+    inTowerRange.clear();
+    type.clear();
+    routeId.clear();
+    pathCursor.clear();
+    indexToId.clear();
+    retiredIds.clear();
+    pendingLaneIds.clear();
+    lanes[0].clear();
+    lanes[1].clear();
+}
+
+// Brings both lane indexes up to date: drops dead and removed units, adds new
+// spawns and re-sorts by x. Units barely move between ticks, so the insertion
+// sort only does a few swaps.
+void UnitStore::RefreshLaneIndex(float deltaTime) {
+    AllocScope allocTag(AllocTag::UNITS);
+    for (int side = 0; side < 2; side++) {
+        LaneIndex& lane = lanes[side];
+        float maxSpeed = 0.0f;
+        int kept = 0;
+        for (int k = 0; k < (int)lane.ids.size(); k++) {
+            int index = IndexOfId(lane.ids[k]);
+            if (index < 0 || !isAlive[index]) continue;
+            lane.ids[kept] = lane.ids[k];
+            lane.keyX[kept] = posX[index];
+            maxSpeed = max(maxSpeed, Stats(index).speed);
+            kept++;
+        }
+        lane.ids.resize(kept);
+        lane.keyX.resize(kept);
+        
+        for (int id : pendingLaneIds) {
+            int index = IndexOfId(id);
+            if (index < 0 || !isAlive[index] || isPlayer[index] != side) continue;
+            lane.ids.push_back(id);
+            lane.keyX.push_back(posX[index]);
+            maxSpeed = max(maxSpeed, Stats(index).speed);
+        }
+        
+        for (int k = 1; k < (int)lane.ids.size(); k++) {
+            int id = lane.ids[k];
+            float key = lane.keyX[k];
+            int j = k - 1;
+            while (j >= 0 && lane.keyX[j] > key) {
+                lane.ids[j + 1] = lane.ids[j];
+                lane.keyX[j + 1] = lane.keyX[j];
+                j--;
+            }
+            lane.ids[j + 1] = id;
+            lane.keyX[j + 1] = key;
+        }
+        
+        lane.keyY.resize(lane.ids.size());
+        lane.index.resize(lane.ids.size());
+        for (int k = 0; k < (int)lane.ids.size(); k++) {
+            lane.index[k] = IndexOfId(lane.ids[k]);
+            lane.keyY[k] = posY[lane.index[k]];
+        }
+        lane.slack = maxSpeed * deltaTime;
+        lane.current = true;
+    }
+    pendingLaneIds.clear();
+    
+    // Removed ids are out of the lanes now, so they can be handed out again
+    freeIds.insert(freeIds.end(), retiredIds.begin(), retiredIds.end());
+    retiredIds.clear();
+}
+
+// Intent phase for one unit. Reads the tick-start state of every unit and
+// writes only this unit's own timers, target and nextX / nextY; damage to
+// other units goes to intents. Units can be planned in any order, or at the
+// same time, with the same result.
+void UnitStore::PlanUpdate(int i, float deltaTime, UnitIntents& intents) {
+    if (!isAlive[i]) return;
+    
+    if (isFrozen[i]) {
+        freezeTimer[i] -= deltaTime;
+        if (freezeTimer[i] <= 0) {
+            isFrozen[i] = false;
+        }
+        return;
+    }
+    
+    if (TargetIndex(i) < 0) {
+        FindTargetWithPriority(i, intents.arena);
+    }
+    
+    int t = TargetIndex(i);
+    if (t >= 0) {
+        float distanceToTarget = CalculateDistance(posX[i], posY[i], posX[t], posY[t]);
+        
+        if (distanceToTarget <= Stats(i).range) {
+            // Unit in range - Attack
+            attackTimer[i] += deltaTime;
+            if (attackTimer[i] >= Stats(i).attackRate) {
+                Attack(i, t, intents);
+                attackTimer[i] = 0.0f;
+            }
+        } else {
+            QueueMove(i, intents.moves);
+            attackTimer[i] = 0.0f;
+        }
+    } else {
+        QueueMove(i, intents.moves);
+    }
+}
+
+// Priority based targeting over the enemy lane index: closest enemy first,
+// then the lowest HP enemy within 10px of that distance
+void UnitStore::FindTargetWithPriority(int i, FrameArena& arena) {
+    const LaneIndex& lane = lanes[isPlayer[i] ? 0 : 1];
+    const vector<float>& keys = lane.keyX;
+    float x = posX[i];
+    float maxDistance = Stats(i).range * 1.5f;
+    float slack = lane.current ? 0.0f : lane.slack;
+    int count = (int)keys.size();
+    
+    // Walk outwards from x to find the closest enemy in range
+    int mid = (int)(lower_bound(keys.begin(), keys.end(), x) - keys.begin());
+    float closest = maxDistance;
+    bool found = false;
+    for (int k = mid; k < count && keys[k] - slack - x <= closest; k++) {
+        float distance = LaneDistance(lane, k, posX[i], posY[i]);
+        if (distance <= closest && LaneUnit(lane, k) >= 0) {
+            closest = distance;
+            found = true;
+        }
+    }
+    for (int k = mid - 1; k >= 0 && x - keys[k] - slack <= closest; k--) {
+        float distance = LaneDistance(lane, k, posX[i], posY[i]);
+        if (distance <= closest && LaneUnit(lane, k) >= 0) {
+            closest = distance;
+            found = true;
+        }
+    }
+    
+    if (!found) {
+        target[i] = UnitHandle();
+        return;
+    }
+    
+    // Lowest HP among enemies close to the closest one
+    float window = min(closest + 10.0f, maxDistance);
+    float reach = window + slack + RANGE_FILTER_MARGIN;
+    int first = (int)(lower_bound(keys.begin(), keys.end(), x - reach) - keys.begin());
+    int last = (int)(upper_bound(keys.begin() + first, keys.end(), x + reach) - keys.begin());
+    ArenaScope scope(arena);
+    ArenaVector<int> candidates(arena);
+    FilterWithinRadius(lane.keyX.data() + first, lane.keyY.data() + first, last - first, { x, posY[i] }, reach, candidates);
+    
+    int best = -1;
+    float bestDistance = 0.0f;
+    for (int k : candidates) {
+        float distance = LaneDistance(lane, first + k, posX[i], posY[i]);
+        if (distance > window) continue;
+        int j = LaneUnit(lane, first + k);
+        if (j < 0) continue;
+        if (best < 0 || currentHP[j] < currentHP[best] ||
+            (currentHP[j] == currentHP[best] && distance < bestDistance)) {
+            best = j;
+            bestDistance = distance;
+        }
+    }
+    target[i] = best >= 0 ? HandleAt(best) : UnitHandle();
+}
+
+// Distance from (x, y) to lane entry k, read from the lane itself while it
+// is current. Entries whose unit is gone are infinitely far away.
+float UnitStore::LaneDistance(const LaneIndex& lane, int k, float x, float y) const {
+    if (lane.current) return CalculateDistance(x, y, lane.keyX[k], lane.keyY[k]);
+    int index = IndexOfId(lane.ids[k]);
+    if (index < 0) return INFINITY;
+    return CalculateDistance(x, y, posX[index], posY[index]);
+}
+
+int UnitStore::LaneUnit(const LaneIndex& lane, int k) const {
+    if (lane.current) return lane.index[k];
+    int index = IndexOfId(lane.ids[k]);
+    if (index < 0 || !isAlive[index]) return -1;
+    return index;
+}
+
+void UnitStore::Attack(int i, int t, UnitIntents& intents) {
+    if (t < 0 || !isAlive[t]) return;
+    
+    int damage = Stats(i).damage;
+    intents.damage.push_back({ HandleAt(t), damage });
+    
+    // Area damage for wizard
+    if (type[i] == UnitType::WIZARD) {
+        ArenaScope scope(intents.arena);
+        ArenaVector<int> hits(intents.arena);
+        QueryRadius(isPlayer[t], { posX[t], posY[t] }, 60.0f, hits);
+        for (int j : hits) {
+            if (j != t) {
+                intents.damage.push_back({ HandleAt(j), damage / 2 }); //reduces actual damage to half
+            }
+        }
+    }
+}
+
+// Snapshot the positions the intent phase reads; planned moves go to nextX / nextY
+void UnitStore::BeginUpdates() {
+    nextX = posX;
+    nextY = posY;
+}
+
+// Commit phase: applies planned moves, then resolves the damage
+void UnitStore::CommitUpdates(const vector<UnitIntents>& intents) {
+    for (int i = 0; i < Count(); i++) {
+        posX[i] = nextX[i];
+        posY[i] = nextY[i];
+    }
+    lanes[0].current = false;
+    lanes[1].current = false;
+    ResolveDamage(intents);
+}
+
+// Sorting by target id groups each unit's hits, and damage is whole HP, so
+// the totals do not depend on which buffer an event was in or in what order
+void UnitStore::ResolveDamage(const vector<UnitIntents>& intents) {
+    mergedDamage.clear();
+    for (const UnitIntents& buffer : intents) {
+        mergedDamage.insert(mergedDamage.end(), buffer.damage.begin(), buffer.damage.end());
+    }
+    sort(mergedDamage.begin(), mergedDamage.end(), [](const DamageEvent& a, const DamageEvent& b) {
+        return a.target.id < b.target.id;
+    });
+
+    int count = (int)mergedDamage.size();
+    for (int k = 0; k < count; ) {
+        UnitHandle target = mergedDamage[k].target;
+        int total = 0;
+        for (; k < count && mergedDamage[k].target.id == target.id; k++) {
+            total += mergedDamage[k].amount;
+        }
+        int index = IndexOf(target);
+        if (index < 0) continue;
+        currentHP[index] -= total;
+        if (currentHP[index] <= 0) {
+            isAlive[index] = false;
+        }
+    }
+}
+
+void UnitStore::generatePath(int i) {
+    routeId[i] = paths.Intern((int)posX[i], isPlayer[i]);
+    pathCursor[i] = 0;
+}
+
+void MoveBatch::clear() {
+    index.clear();
+    x.clear();
+    y.clear();
+    targetX.clear();
+    targetY.clear();
+    speed.clear();
+    advance.clear();
+}
+
+void MoveBatch::reserve(int count) {
+    index.reserve(count);
+    x.reserve(count);
+    y.reserve(count);
+    targetX.reserve(count);
+    targetY.reserve(count);
+    speed.reserve(count);
+    advance.reserve(count);
+}
+
+// A unit's hit plus wizard splash, with room to spare
+void UnitIntents::Reserve(int units) {
+    damage.reserve(units * 4);
+    arena.Reserve((size_t)units * ARENA_BYTES_PER_UNIT);
+    moves.reserve(units);
+}
+
+void UnitStore::QueueMove(int i, MoveBatch& moves) const {
+    const vector<Vec2>& waypoints = paths.Waypoints(routeId[i]);
+    if (pathCursor[i] >= (int)waypoints.size()) return;
+    
+    Vec2 targetPos = waypoints[pathCursor[i]];
+    moves.index.push_back(i);
+    moves.x.push_back(posX[i]);
+    moves.y.push_back(posY[i]);
+    moves.targetX.push_back(targetPos.x);
+    moves.targetY.push_back(targetPos.y);
+    moves.speed.push_back(Stats(i).speed);
+}
+
+// Moves batch entries [first, count) a full Lanes::WIDTH at a time and
+// returns where it stopped. A unit within 5 px of its waypoint does not move
+// and is flagged to advance to the next one. Written once for every lane
+// width so the scalar and vector paths do the same float ops in the same order.
+template <typename Lanes>
+static int MoveTowardWaypoints(MoveBatch& moves, int first, int count, float deltaTime) {
+    Lanes step = Lanes::Set1(deltaTime);
+    Lanes reached = Lanes::Set1(5.0f);
+    int k = first;
+    for (; k + Lanes::WIDTH <= count; k += Lanes::WIDTH) {
+        Lanes x = Lanes::Load(&moves.x[k]);
+        Lanes y = Lanes::Load(&moves.y[k]);
+        Lanes directionX = Lanes::Load(&moves.targetX[k]) - x;
+        Lanes directionY = Lanes::Load(&moves.targetY[k]) - y;
+        // Calculate distance to the target point
+        Lanes distance = Sqrt(directionX * directionX + directionY * directionY);
+        auto advance = Less(distance, reached);
+        
+        Lanes speed = Lanes::Load(&moves.speed[k]);
+        Lanes movedX = x + directionX / distance * speed * step;
+        Lanes movedY = y + directionY / distance * speed * step;
+        Select(advance, x, movedX).Store(&moves.x[k]);
+        Select(advance, y, movedY).Store(&moves.y[k]);
+        
+        unsigned bits = Bits(advance);
+        for (int lane = 0; lane < Lanes::WIDTH; lane++) {
+            moves.advance[k + lane] = (bits >> lane) & 1;
+        }
+    }
+    return k;
+}
+
+void UnitStore::MoveQueued(MoveBatch& moves, float deltaTime) {
+    int count = (int)moves.index.size();
+    moves.advance.resize(count);
+    
+    int done = MoveTowardWaypoints<FloatLanes>(moves, 0, count, deltaTime);
+    MoveTowardWaypoints<ScalarLanes>(moves, done, count, deltaTime);
+    
+    for (int k = 0; k < count; k++) {
+        int i = moves.index[k];
+        if (moves.advance[k]) {
+            pathCursor[i]++;
+        } else {
+            nextX[i] = moves.x[k];
+            nextY[i] = moves.y[k];
+        }
+    }
+    moves.clear();
+}
+
+// The lane is sorted by x, so only the [x - radius, x + radius] slice (widened
+// by the lane slack) needs an exact distance check. Everything is on LANE_Y
+// today; a 2D grid can sit behind the same call later.
+// Writes the offsets that pass to out and returns how many there were
+template <typename Lanes>
+static int FilterBlocks(const float* xs, const float* ys, int first, int count, Vec2 center, float radius,
+                        int* out, int& k) {
+    Lanes centerX = Lanes::Set1(center.x);
+    Lanes centerY = Lanes::Set1(center.y);
+    Lanes radiusSquared = Lanes::Set1(radius * radius);
+    int found = 0;
+    for (k = first; k + Lanes::WIDTH <= count; k += Lanes::WIDTH) {
+        Lanes dx = Lanes::Load(xs + k) - centerX;
+        Lanes dy = Lanes::Load(ys + k) - centerY;
+        unsigned bits = Bits(Less(dx * dx + dy * dy, radiusSquared));
+        while (bits) {
+            out[found++] = k + CountTrailingZeros(bits);
+            bits &= bits - 1;
+        }
+    }
+    return found;
+}
+
+void FilterWithinRadius(const float* xs, const float* ys, int count, Vec2 center, float radius,
+                        ArenaVector<int>& out) {
+    // Room for every offset, trimmed to what passed afterwards
+    size_t start = out.size();
+    out.resize(start + count);
+    int* write = out.data() + start;
+    int done;
+    int found = FilterBlocks<FloatLanes>(xs, ys, 0, count, center, radius, write, done);
+    found += FilterBlocks<ScalarLanes>(xs, ys, done, count, center, radius, write + found, done);
+    out.resize(start + found);
+}
+
+void UnitStore::QueryRadius(bool player, Vec2 center, float radius, ArenaVector<int>& out) const {
+    out.clear();
+    const LaneIndex& lane = Lane(player);
+    // Filter with a widened radius, then check every candidate exactly, like
+    // FindTargetWithPriority. Candidates become dense indices in place.
+    float reach = radius + (lane.current ? 0.0f : lane.slack) + RANGE_FILTER_MARGIN;
+    int first = (int)(lower_bound(lane.keyX.begin(), lane.keyX.end(), center.x - reach) - lane.keyX.begin());
+    int last = (int)(upper_bound(lane.keyX.begin() + first, lane.keyX.end(), center.x + reach) - lane.keyX.begin());
+    FilterWithinRadius(lane.keyX.data() + first, lane.keyY.data() + first, last - first, center, reach, out);
+    
+    int kept = 0;
+    for (int k : out) {
+        int j = LaneUnit(lane, first + k);
+        if (j < 0) continue;
+        float dx = posX[j] - center.x;
+        float dy = posY[j] - center.y;
+        if (dx * dx + dy * dy < radius * radius) {
+            out[kept++] = j;
+        }
+    }
+    out.resize(kept);
+}
+
+int UnitStore::TargetIndex(int i) const {
+    int t = IndexOf(target[i]);
+    if (t < 0 || !isAlive[t]) return -1;
+    return t;
+}
+
+float UnitStore::CalculateDistance(float ax, float ay, float bx, float by) const {
+    return sqrt((ax - bx) * (ax - bx) + (ay - by) * (ay - by));
+}
+
+int SimClock::Advance(float frameTime) {
+    accumulator += frameTime;
+    int steps = (int)(accumulator / SIM_DT);
+    if (steps > SIM_MAX_SUBSTEPS) {
+        steps = SIM_MAX_SUBSTEPS;
+        accumulator = fmod(accumulator, (double)SIM_DT);
+    } else {
+        accumulator -= steps * (double)SIM_DT;
+    }
+    tick += steps;
+    return steps;
+}
+
+int SimRandom::Range(int min, int max) {
+    state ^= state << 13;
+    state ^= state >> 17;
+    state ^= state << 5;
+    return min + (int)(state % (unsigned)(max - min + 1));
+}
+
+void Tower::Reset() {
+    maxHP = TOWER_HP;
+    currentHP = maxHP;
+    damage = TOWER_DAMAGE;
+    attackRate = TOWER_ATTACK_RATE;
+    attackTimer = 0.0f;
+    isAlive = true;
+    
+    if (isPlayer) {
+        position = { 50.0f, LANE_Y };
+    } else {
+        position = { (float)SCREEN_WIDTH - 50.0f, LANE_Y };
+    }
+    inRange.clear();
+}
+
+void Tower::Reserve(int units) {
+    inRange.reserve(units);
+}
+
+void Tower::Update(float deltaTime, UnitStore& units, FrameArena& arena) {
+    if (!isAlive) return;
+    attackTimer += deltaTime;
+    
+    // Track units entering and leaving range
+    UpdateTargetQueue(units, arena);
+}
+
+// Incrementally maintain the set of enemies in range. Only the part of the
+// enemy lane near the tower is visited, so the cost follows the number of
+// units around the tower rather than the army size.
+void Tower::UpdateTargetQueue(UnitStore& units, FrameArena& arena) {
+    // Exits: drop units that died, were removed or walked out of range
+    int kept = 0;
+    for (int k = 0; k < (int)inRange.size(); k++) {
+        int i = units.IndexOf(inRange[k]);
+        if (i < 0) continue;
+        if (!units.isAlive[i] || CalculateDistance(position, { units.posX[i], units.posY[i] }) >= TOWER_RANGE) {
+            units.inTowerRange[i] = false;
+            continue;
+        }
+        inRange[kept++] = inRange[k];
+    }
+    inRange.resize(kept);
+    
+    // Entries: enemies that can be in range and are not tracked yet
+    const LaneIndex& lane = units.Lane(!isPlayer);
+    float reach = TOWER_RANGE + lane.slack + RANGE_FILTER_MARGIN;
+    int first = (int)(lower_bound(lane.keyX.begin(), lane.keyX.end(), position.x - reach) - lane.keyX.begin());
+    int last = (int)(upper_bound(lane.keyX.begin() + first, lane.keyX.end(), position.x + reach) - lane.keyX.begin());
+    ArenaScope scope(arena);
+    ArenaVector<int> candidates(arena);
+    FilterWithinRadius(lane.keyX.data() + first, lane.keyY.data() + first, last - first, position, reach, candidates);
+    for (int k : candidates) {
+        int i = units.LaneUnit(lane, first + k);
+        if (i < 0 || units.inTowerRange[i]) continue;
+        if (CalculateDistance(position, { units.posX[i], units.posY[i] }) < TOWER_RANGE) {
+            units.inTowerRange[i] = true;
+            inRange.push_back(units.HandleAt(i));
+        }
+    }
+}
+
+// Best target, stale handle if none. Only evaluated when the tower is
+// about to fire.
+UnitHandle Tower::GetBestTarget(const UnitStore& units) {
+    UnitHandle best;
+    TowerTargetKey bestKey = {};
+    for (UnitHandle handle : inRange) {
+        int i = units.IndexOf(handle);
+        if (i < 0 || !units.isAlive[i]) continue;
+        float distance = CalculateDistance(position, { units.posX[i], units.posY[i] });
+        TowerTargetKey key = { (int)(distance / 10.0f), units.currentHP[i], handle.id };
+        if (best.id < 0 || key < bestKey) {
+            best = handle;
+            bestKey = key;
+        }
+    }
+    return best;
+}
+
+float Tower::CalculateDistance(Vec2 a, Vec2 b) {
+    return sqrt((a.x - b.x) * (a.x - b.x) + (a.y - b.y) * (a.y - b.y));
+}
+
+Game::Game(unsigned seed)
+    : playerTower(true), enemyTower(false), projectiles(PROJECTILE_CAPACITY), seed(seed), random(seed) {
+    currentState = GameState::START_SCREEN; // Start with start screen
+    playerElixir = 5;
+    elixirTimer = 0.0f;
+    gameOver = false;
+    winner = "";
+    playerUnitsSpawned = 0;
+    enemyUnitsSpawned = 0;
+    
+    // Initialize freeze ability
+    freezeAvailable = true;
+    freezeCooldown = 0.0f;
+    
+    // Initialize game timer
+    gameTimer = GAME_TIME_LIMIT;
+    
+    // Initialize wave progression
+    InitializeWaves();
+    waveSpawnTimer = 0.0f;
+    currentUnitTypeIndex = 0;
+    unitsSpawnedForCurrentType = 0;
+    isBetweenWaves = false;
+    betweenWavesTimer = 0.0f;
+
+    ReserveStorage();
+}
+
+void Game::Update(float deltaTime) {
+    if (currentState != GameState::PLAYING) return;
+
+    if (gameOver) {
+        currentState = GameState::GAME_OVER;
+        return;
+    }
+
+    ResetArenas();
+
+    UpdateTimers(deltaTime);
+
+    units.RefreshLaneIndex(deltaTime);
+
+    UpdateTowers(deltaTime);
+
+    UpdateUnits(deltaTime);
+
+    UpdateProjectiles(deltaTime);
+
+    HandleTowerAttacks();
+
+    // Everything spawned this tick shows up in the next snapshot
+    effects.Drain(projectiles);
+
+    HandleWaveProgression(deltaTime);
+}
+
+void Game::ResetArenas() {
+    size_t bytes = (size_t)max(units.Count(), UNIT_RESERVE) * ARENA_BYTES_PER_UNIT;
+    for (UnitIntents& intents : unitIntents) {
+        if (intents.arena.Stats().capacity < bytes) {
+            AllocScope allocTag(AllocTag::UNITS);
+            intents.arena.Reserve(bytes * 2);
+        }
+        intents.arena.Reset();
+    }
+}
+
+FrameArenaStats Game::ArenaStats() const {
+    FrameArenaStats total;
+    for (const UnitIntents& intents : unitIntents) {
+        const FrameArenaStats& stats = intents.arena.Stats();
+        total.capacity = max(total.capacity, stats.capacity);
+        total.peak = max(total.peak, stats.peak);
+        total.overflows += stats.overflows;
+    }
+    return total;
+}
+
+// Freeze cooldown, match clock and elixir
+void Game::UpdateTimers(float deltaTime) {
+    if (!freezeAvailable) {
+        freezeCooldown -= deltaTime;
+        if (freezeCooldown <= 0) {
+            freezeAvailable = true;
+            freezeCooldown = 0.0f;
+        }
+    }
+
+    gameTimer -= deltaTime;
+    if (gameTimer <= 0) {
+        gameTimer = 0;
+        gameOver = true;
+        winner = "Draw";
+    }
+
+    // Update elixir
+    elixirTimer += deltaTime;
+    if (elixirTimer >= ELIXIR_RATE) {
+        if (playerElixir < MAX_ELIXIR) playerElixir++;
+        elixirTimer = 0.0f;
+    }
+}
+
+// Two towers are too little work to wake the job system for, so they run
+// on the calling thread
+void Game::UpdateTowers(float deltaTime) {
+    AllocScope allocTag(AllocTag::TOWERS);
+    playerTower.Update(deltaTime, units, unitIntents[0].arena);
+    enemyTower.Update(deltaTime, units, unitIntents[0].arena);
+}
+
+// Moves, retargets and attacks with every unit, applies tower hits and
+// removes the dead. Units first plan against the tick-start state, then the
+// moves are committed and the damage goes through ResolveDamage.
+void Game::UpdateUnits(float deltaTime) {
+    AllocScope allocTag(AllocTag::UNITS);
+    ResetIntents();
+    units.BeginUpdates();
+    ForEachRange(units.Count(), UNIT_GRAIN, [&](int begin, int end, int thread) {
+        for (int i = begin; i < end; i++) {
+            units.PlanUpdate(i, deltaTime, unitIntents[thread]);
+        }
+        units.MoveQueued(unitIntents[thread].moves, deltaTime);
+    });
+    units.CommitUpdates(unitIntents);
+    
+    //  Units touching the other side's tower hit it
+    ForEachRange(units.Count(), UNIT_GRAIN, [&](int begin, int end, int thread) {
+        UnitIntents& intents = unitIntents[thread];
+        for (int i = begin; i < end; i++) {
+            if (!units.isAlive[i]) continue;
+            Vec2 unitPos = { units.posX[i], units.posY[i] };
+            if (units.isPlayer[i] && unitPos.x >= enemyTower.position.x - 60) {
+                intents.towerDamage[1] += units.Stats(i).damage;
+                CreateAttackEffect(thread, units.HandleAt(i).id, unitPos, enemyTower.position, units.Stats(i).color);
+            } else if (!units.isPlayer[i] && unitPos.x <= playerTower.position.x + 60) {
+                intents.towerDamage[0] += units.Stats(i).damage;
+                CreateAttackEffect(thread, units.HandleAt(i).id, unitPos, playerTower.position, units.Stats(i).color);
+            }
+        }
+    });
+    
+    int playerTowerDamage = 0;
+    int enemyTowerDamage = 0;
+    for (const UnitIntents& intents : unitIntents) {
+        playerTowerDamage += intents.towerDamage[0];
+        enemyTowerDamage += intents.towerDamage[1];
+    }
+    if (enemyTowerDamage > 0) {
+        enemyTower.currentHP -= enemyTowerDamage;
+        if (enemyTower.currentHP <= 0) {
+            enemyTower.currentHP = 0;
+            enemyTower.isAlive = false;
+            gameOver = true;
+            winner = "Player Wins!";
+        }
+    }
+    if (playerTowerDamage > 0) {
+        playerTower.currentHP -= playerTowerDamage;
+        if (playerTower.currentHP <= 0) {
+            playerTower.currentHP = 0;
+            playerTower.isAlive = false;
+            gameOver = true;
+            winner = "Enemy Wins!";
+        }
+    }
+    
+    // Remove dead units, the last unit takes this slot
+    for (int i = 0; i < units.Count(); ) {
+        if (units.isAlive[i]) {
+            ++i;
+        } else {
+            units.Remove(i);
+        }
+    }
+}
+
+void Game::UpdateProjectiles(float deltaTime) {
+    AllocScope allocTag(AllocTag::PROJECTILES);
+    ForEachRange(projectiles.Count(), PROJECTILE_GRAIN, [&](int begin, int end, int) {
+        for (int k = begin; k < end; k++) {
+            projectiles[k].Update(deltaTime);
+        }
+    });
+
+    // Remove dead projectiles, they are all at the front
+    projectiles.ExpireFront();
+}
+
+void Game::SpawnUnit(UnitType type) {
+    if (currentState != GameState::PLAYING) return;
+    
+    const UnitStats& stats = GetUnitStats(type);
+    if (playerElixir >= stats.cost) {
+        units.Spawn(type, true);// Creates unit
+        playerUnitsSpawned++;
+        playerElixir -= stats.cost;// subtracts elixir
+    }
+}
+
+void Game::ActivateFreeze() {
+    if (currentState != GameState::PLAYING) return;
+    if (!freezeAvailable) return;
+    
+    // Freeze all enemy units
+    for (int i = 0; i < units.Count(); i++) {
+        if (!units.isPlayer[i] && units.isAlive[i]) {
+            units.isFrozen[i] = true;
+            units.freezeTimer[i] = FREEZE_DURATION;
+        }
+    }
+    
+    freezeAvailable = false;
+    freezeCooldown = FREEZE_COOLDOWN;
+    CreateFreezeEffect();
+}
+
+void Game::CreateFreezeEffect() {
+    for (int i = 0; i < 20; i++) {
+        Vec2 startPos = { (float)(random.Range(0, SCREEN_WIDTH)), (float)(random.Range(0, SCREEN_HEIGHT)) };
+        Vec2 endPos = { (float)(random.Range(0, SCREEN_WIDTH)), (float)(random.Range(0, SCREEN_HEIGHT)) };
+        effects.Push(0, { EFFECT_SOURCE_FREEZE, i, startPos, endPos, PALETTE_SKYBLUE });
+    }
+}
+
+void Game::CreateAttackEffect(int thread, int source, Vec2 from, Vec2 to, Rgba color) {
+    effects.Push(thread, { source, 0, from, to, color });
+}
+
+void ProjectileRing::SetCapacity(int capacity) {
+    ring.assign(max(capacity, 1), Projectile({ 0.0f, 0.0f }, { 0.0f, 0.0f }, {}));
+    Clear();
+}
+
+void ProjectileRing::Push(const Projectile& projectile) {
+    if (count == (int)ring.size()) {
+        // Full, the oldest makes room
+        head = Slot(1);
+        count--;
+    }
+    ring[Slot(count)] = projectile;
+    count++;
+}
+
+void ProjectileRing::ExpireFront() {
+    while (count > 0 && !ring[head].active) {
+        head = Slot(1);
+        count--;
+    }
+}
+
+void EffectQueue::SetThreadCount(int threads) {
+    if (threads > (int)buffers.size()) buffers.resize(threads);
+}
+
+void EffectQueue::Reserve(int count) {
+    for (auto& buffer : buffers) {
+        buffer.reserve(count);
+    }
+    merged.reserve(count);
+}
+
+void EffectQueue::Drain(ProjectileRing& projectiles) {
+    AllocScope allocTag(AllocTag::PROJECTILES);
+    merged.clear();
+    for (auto& buffer : buffers) {
+        merged.insert(merged.end(), buffer.begin(), buffer.end());
+        buffer.clear();
+    }
+    sort(merged.begin(), merged.end(), [](const EffectSpawn& a, const EffectSpawn& b) {
+        return a.source != b.source ? a.source < b.source : a.sequence < b.sequence;
+    });
+    for (const EffectSpawn& effect : merged) {
+        projectiles.Push(Projectile(effect.from, effect.to, effect.color));
+    }
+}
+
+void EffectQueue::Clear() {
+    for (auto& buffer : buffers) {
+        buffer.clear();
+    }
+}
+
+void Game::Start() {
+    currentState = GameState::PLAYING;
+}
+
+void Game::Restart() {
+    Reset();
+    currentState = GameState::PLAYING;
+}
+
+void Game::SetSeed(unsigned matchSeed) {
+    seed = matchSeed;
+}
+
+void Game::SetJobSystem(JobSystem* jobSystem) {
+    jobs = jobSystem;
+    ReserveStorage();
+}
+
+static TowerSnapshot SnapshotTower(const Tower& tower) {
+    return { tower.position, tower.currentHP, tower.maxHP, tower.isPlayer, tower.isAlive };
+}
+
+void Game::WriteSnapshot(RenderSnapshot& out, long long tick) const {
+    AllocScope allocTag(AllocTag::SNAPSHOT);
+    out.tick = tick;
+    out.state = currentState;
+    out.winner = winner;
+    out.playerTower = SnapshotTower(playerTower);
+    out.enemyTower = SnapshotTower(enemyTower);
+    
+    out.units.clear();
+    for (int i = 0; i < units.Count(); i++) {
+        if (!units.isAlive[i]) continue;
+        
+        UnitSnapshot unit;
+        unit.position = { units.posX[i], units.posY[i] };
+        unit.currentHP = units.currentHP[i];
+        unit.type = units.type[i];
+        unit.isPlayer = units.isPlayer[i];
+        unit.isFrozen = units.isFrozen[i];
+        
+        int t = units.TargetIndex(i);
+        unit.hasTarget = t >= 0;
+        unit.targetPosition = unit.hasTarget ? Vec2{ units.posX[t], units.posY[t] } : unit.position;
+        
+        const vector<Vec2>& waypoints = units.Waypoints(i);
+        int cursor = min(units.pathCursor[i], (int)waypoints.size());
+        unit.waypoints = waypoints.data() + cursor;
+        unit.waypointCount = (int)waypoints.size() - cursor;
+        out.units.push_back(unit);
+    }
+    
+    out.projectiles.clear();
+    for (int k = 0; k < projectiles.Count(); k++) {
+        const Projectile& projectile = projectiles[k];
+        if (projectile.active) {
+            out.projectiles.push_back({ projectile.CurrentPosition(), projectile.color });
+        }
+    }
+    
+    out.playerElixir = playerElixir;
+    out.maxElixir = MAX_ELIXIR;
+    out.gameTimer = gameTimer;
+    out.freezeAvailable = freezeAvailable;
+    out.freezeCooldown = freezeCooldown;
+    out.currentWave = currentWave;
+    out.isBetweenWaves = isBetweenWaves;
+    out.betweenWavesTimer = betweenWavesTimer;
+    out.currentUnitTypeIndex = currentUnitTypeIndex;
+    out.unitsSpawnedForCurrentType = unitsSpawnedForCurrentType;
+}
+
+template <typename Body>
+void Game::ForEachRange(int count, int minGrain, const Body& body) {
+    if (!jobs) {
+        if (count > 0) body(0, count, 0);
+        return;
+    }
+    AllocTag tag = currentAllocTag;
+    jobs->ParallelFor(count, minGrain, [&](int begin, int end, int thread) {
+        AllocScope allocTag(tag);
+        body(begin, end, thread);
+    });
+}
+
+void Game::ReserveStorage() {
+    units.Reserve(UNIT_RESERVE);
+    playerTower.Reserve(UNIT_RESERVE);
+    enemyTower.Reserve(UNIT_RESERVE);
+    ResetIntents();
+    for (UnitIntents& intents : unitIntents) {
+        intents.Reserve(UNIT_RESERVE);
+    }
+    effects.Reserve(PROJECTILE_CAPACITY);
+}
+
+void Game::ResetIntents() {
+    unitIntents.resize(jobs ? jobs->ThreadCount() : 1);
+    effects.SetThreadCount((int)unitIntents.size());
+    for (UnitIntents& intents : unitIntents) {
+        intents.damage.clear();
+        intents.towerDamage[0] = 0;
+        intents.towerDamage[1] = 0;
+    }
+}
+
+void Game::Reset() {
+    random = SimRandom(seed);
+    units.Clear();
+    projectiles.Clear();
+    effects.Clear();
+    playerTower.Reset();
+    enemyTower.Reset();
+    playerElixir = 5;
+    elixirTimer = 0.0f;
+    gameOver = false;
+    winner = "";
+    playerUnitsSpawned = 0;
+    enemyUnitsSpawned = 0;
+    gameTimer = GAME_TIME_LIMIT;
+    
+    freezeAvailable = true;
+    freezeCooldown = 0.0f;
+    
+    InitializeWaves();
+    waveSpawnTimer = 0.0f;
+    currentUnitTypeIndex = 0;
+    unitsSpawnedForCurrentType = 0;
+    isBetweenWaves = false;
+    betweenWavesTimer = 0.0f;
+}
+
+void Game::HandleTowerAttacks() {
+    AllocScope allocTag(AllocTag::TOWERS);
+    ResetIntents();
+
+    // Both towers pick a target and fire at once, the hits go through the
+    // damage reduction like unit attacks. Inline, like UpdateTowers.
+    for (int k = 0; k < 2; k++) {
+        Tower& tower = k == 0 ? playerTower : enemyTower;
+        if (!tower.CanAttack()) continue;
+        int bestTarget = units.IndexOf(tower.GetBestTarget(units));
+        if (bestTarget < 0) continue;
+
+        unitIntents[0].damage.push_back({ units.HandleAt(bestTarget), tower.damage });
+        CreateAttackEffect(0, k == 0 ? EFFECT_SOURCE_PLAYER_TOWER : EFFECT_SOURCE_ENEMY_TOWER, tower.position,
+            { units.posX[bestTarget], units.posY[bestTarget] }, k == 0 ? PALETTE_BLUE : PALETTE_RED);
+        tower.ResetAttackTimer();
+    }
+    units.ResolveDamage(unitIntents);
+}
+
+// Builds the shared wave list, see GetWaveList
+static vector<GameWave> BuildWaves() {
+    // Wave progression
+    vector<WaveUnit> wave1Units = { WaveUnit(UnitType::KNIGHT, 2), WaveUnit(UnitType::WIZARD, 1) };
+    vector<WaveUnit> wave2Units = { WaveUnit(UnitType::GIANT, 1), WaveUnit(UnitType::KNIGHT, 1), WaveUnit(UnitType::ARCHER, 1) };
+    vector<WaveUnit> wave3Units = { WaveUnit(UnitType::ARCHER, 2), WaveUnit(UnitType::WIZARD, 1) };
+    vector<WaveUnit> wave4Units = { WaveUnit(UnitType::GIANT, 1), WaveUnit(UnitType::WIZARD, 2) };
+    vector<WaveUnit> wave5Units = { WaveUnit(UnitType::KNIGHT, 2), WaveUnit(UnitType::ARCHER, 1), WaveUnit(UnitType::GIANT, 1) };
+    vector<WaveUnit> wave6Units = { WaveUnit(UnitType::WIZARD, 1), WaveUnit(UnitType::ARCHER, 2), WaveUnit(UnitType::KNIGHT, 1) };
+    vector<WaveUnit> wave7Units = { WaveUnit(UnitType::GIANT, 1), WaveUnit(UnitType::WIZARD, 1), WaveUnit(UnitType::ARCHER, 2) };
+    vector<WaveUnit> wave8Units = { WaveUnit(UnitType::KNIGHT, 2), WaveUnit(UnitType::GIANT, 1), WaveUnit(UnitType::WIZARD, 1) };
+    //// Create waves with their units, spawn rate, and cooldown
+    vector<GameWave> waves;
+    waves.reserve(8);
+    waves.emplace_back(1, wave1Units, 4.0f, 10.0f);
+    waves.emplace_back(2, wave2Units, 3.5f, 10.0f);
+    waves.emplace_back(3, wave3Units, 3.5f, 10.0f);
+    waves.emplace_back(4, wave4Units, 3.5f, 10.0f);
+    waves.emplace_back(5, wave5Units, 3.0f, 10.0f);
+    waves.emplace_back(6, wave6Units, 3.0f, 10.0f);
+    waves.emplace_back(7, wave7Units, 2.5f, 10.0f);
+    waves.emplace_back(8, wave8Units, 2.5f, 10.0f);
+    
+    for (size_t w = 0; w + 1 < waves.size(); w++) {
+        waves[w].nextWave = &waves[w + 1];
+    }
+    return waves;
+}
+
+const GameWave* GetWaveList() {
+    static const vector<GameWave> waves = BuildWaves();
+    return &waves[0];
+}
+
+void Game::InitializeWaves() {
+    waveList = GetWaveList();
+    currentWave = waveList;
+    
+    // Spawn rates speed up as the match goes on, so each game keeps its own copy
+    waveSpawnRates.clear();
+    for (const GameWave* wave = waveList; wave; wave = wave->nextWave) {
+        waveSpawnRates.push_back(wave->spawnRate);
+    }
+}
+
+void Game::HandleWaveProgression(float deltaTime) {
+    AllocScope allocTag(AllocTag::WAVES);
+    if (!currentWave || gameOver) return;
+    
+    if (isBetweenWaves) {
+        betweenWavesTimer -= deltaTime;
+        if (betweenWavesTimer <= 0) {
+            isBetweenWaves = false;
+            waveSpawnTimer = 0.0f;
+            currentUnitTypeIndex = 0;
+            unitsSpawnedForCurrentType = 0;
+        }
+        return;
+    }
+    
+    waveSpawnTimer += deltaTime;
+    
+    if (currentUnitTypeIndex < (int)currentWave->waveUnits.size()) {
+        const WaveUnit& currentUnitType = currentWave->waveUnits[currentUnitTypeIndex];
+        
+        if (waveSpawnTimer >= waveSpawnRates[currentWave->waveNumber - 1] && 
+            unitsSpawnedForCurrentType < currentUnitType.count) {
+            
+            units.Spawn(currentUnitType.type, false);
+            enemyUnitsSpawned++;
+            unitsSpawnedForCurrentType++;
+            waveSpawnTimer = 0.0f;
+            
+            // Check if spawning unit finished in a wave 
+            if (unitsSpawnedForCurrentType >= currentUnitType.count) {
+                // Move to next unit type 
+                currentUnitTypeIndex++;
+                unitsSpawnedForCurrentType = 0;
+                waveSpawnTimer = 0.0f;
+            }
+        }
+    } else {
+        // Units spawned in the wave
+        isBetweenWaves = true;
+        betweenWavesTimer = currentWave->waveCooldown;
+        
+        if (currentWave->nextWave) {
+            currentWave = currentWave->nextWave;
+        } else {
+            currentWave = waveList;
+            for (float& rate : waveSpawnRates) {
+                rate = max(2.0f, rate * 0.9f);
+            }
+        }
+    }
+}
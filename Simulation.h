@@ -0,0 +1,679 @@
+/*
+	Tower Defense simulation.
+	Everything needed to play a match (units, towers, waves, game rules)
+	without a window, audio device or keyboard. Projectnew.cpp draws it with
+	raylib and feeds it player input; Headless.cpp runs it on its own.
+*/
+#pragma once
+
+#include "FrameArena.h"
+#include <vector>
+#include <string>
+#include <string_view>
+
+class JobSystem;
+
+//Constant throughout the game
+const int SCREEN_WIDTH = 1200;
+const int SCREEN_HEIGHT = 800;
+const int LANE_Y = SCREEN_HEIGHT / 2;
+
+// Tower
+const int TOWER_HP = 3500;
+const int TOWER_DAMAGE = 50;
+const float TOWER_ATTACK_RATE = 1.0f;
+const float TOWER_RANGE = 300.0f;
+
+// Simulation runs at a fixed rate, independent of the render frame rate
+const int SIM_TICK_RATE = 60;
+const float SIM_DT = 1.0f / SIM_TICK_RATE;
+const int SIM_MAX_SUBSTEPS = 8; // catch-up cap per render frame
+
+// Storage reserved up front, enough for a busy match, so steady play never
+// grows an array. Beyond these counts the arrays still grow as needed.
+const int UNIT_RESERVE = 256;
+// Live effects kept by default, the oldest are dropped beyond this. Set per
+// game with ProjectileRing::SetCapacity.
+const int PROJECTILE_CAPACITY = 1024;
+// Frame arena space per thread, per unit. A range query needs an int for
+// every unit of a side.
+const int ARENA_BYTES_PER_UNIT = 16;
+
+// Plain value types so the simulation does not depend on raylib. They have
+// the same layout as raylib's Vector2 and Color.
+struct Vec2 {
+    float x;
+    float y;
+};
+
+struct Rgba {
+    unsigned char r;
+    unsigned char g;
+    unsigned char b;
+    unsigned char a;
+};
+
+// raylib palette values used by the simulation
+constexpr Rgba PALETTE_BLUE = { 0, 121, 241, 255 };
+constexpr Rgba PALETTE_GREEN = { 0, 228, 48, 255 };
+constexpr Rgba PALETTE_GRAY = { 130, 130, 130, 255 };
+constexpr Rgba PALETTE_PURPLE = { 200, 122, 255, 255 };
+constexpr Rgba PALETTE_RED = { 230, 41, 55, 255 };
+constexpr Rgba PALETTE_SKYBLUE = { 102, 191, 255, 255 };
+
+//enum means fixed values like here gamestates can only be of three types
+enum class GameState {
+    START_SCREEN,
+    PLAYING,
+    GAME_OVER
+};
+
+enum class UnitType : unsigned char {
+    KNIGHT,
+    ARCHER,
+    GIANT,
+    WIZARD
+};
+
+// Cache line aligned, so looking up one type's stats touches one line
+struct alignas(64) UnitStats {
+    std::string_view name;
+    int cost;
+    int hp;
+    int damage;
+    float speed;
+    float attackRate;
+    float range;
+    bool isRanged;
+    Rgba color;
+    int size;
+};
+
+// Stats of every unit type, indexed by UnitType. Units and the UI read from
+// here instead of keeping their own copies.
+constexpr UnitStats UNIT_STATS[] = {
+    {"Knight", 3, 300, 60, 80.0f, 1.2f, 40.0f, false, PALETTE_BLUE, 25},
+    {"Archer", 3, 150, 40, 60.0f, 1.5f, 150.0f, true, PALETTE_GREEN, 20},
+    {"Giant", 5, 1000, 80, 40.0f, 2.0f, 50.0f, false, PALETTE_GRAY, 35},
+    {"Wizard", 4, 180, 70, 50.0f, 2.5f, 120.0f, true, PALETTE_PURPLE, 22}
+};
+static_assert(sizeof(UNIT_STATS) / sizeof(UNIT_STATS[0]) == (int)UnitType::WIZARD + 1, "UNIT_STATS must cover every UnitType");
+static_assert(sizeof(UnitStats) == 64, "each UNIT_STATS entry should fill exactly one cache line");
+
+constexpr const UnitStats& GetUnitStats(UnitType type) {
+    return UNIT_STATS[(int)type];
+}
+
+struct WaveUnit {
+    UnitType type;
+    int count;
+
+    WaveUnit(UnitType t, int c) : type(t), count(c) {}
+};
+
+// Generational reference to a unit: the id of its slot in UnitStore plus the
+// slot's generation when the handle was taken. Removing a unit bumps the
+// generation, so handles to it go stale instead of dangling, and the check is
+// O(1) no matter how the store has moved units around.
+struct UnitHandle {
+    int id = -1;
+    unsigned generation = 0;
+};
+static_assert(sizeof(UnitHandle) == 8, "UnitHandle is stored per unit and per damage event");
+
+// Damage a unit or tower deals to a unit during a tick
+struct DamageEvent {
+    UnitHandle target;
+    int amount;
+};
+
+// Units following their path this tick, gathered into flat arrays for the
+// movement kernel
+struct MoveBatch {
+    std::vector<int> index;
+    std::vector<float> x;
+    std::vector<float> y;
+    std::vector<float> targetX; // current waypoint
+    std::vector<float> targetY;
+    std::vector<float> speed;
+    std::vector<unsigned char> advance; // reached the waypoint, moves on to the next instead
+
+    void clear();
+    void reserve(int count);
+};
+
+// Output of the intent phase. Each thread planning units owns one.
+struct UnitIntents {
+    std::vector<DamageEvent> damage;
+    FrameArena arena; // this tick's temporaries, see Game::ResetArenas
+    MoveBatch moves;
+    int towerDamage[2]; // from units touching a tower, [0] player tower, [1] enemy tower
+
+    void Reserve(int units);
+};
+
+// Units of one side ordered by x along the lane. keyX / keyY hold each
+// unit's position at the last refresh; slack is how far any unit can have
+// moved since then. While current is set no unit has moved, died or been
+// removed since the refresh, so keyX / keyY and the dense indices in index
+// are exact and slack does not apply.
+struct LaneIndex {
+    std::vector<int> ids;
+    std::vector<float> keyX;
+    std::vector<float> keyY;
+    std::vector<int> index;
+    float slack = 0.0f;
+    bool current = false;
+
+    void clear() {
+        ids.clear();
+        keyX.clear();
+        keyY.clear();
+        index.clear();
+        slack = 0.0f;
+        current = false;
+    }
+    void reserve(int count) {
+        ids.reserve(count);
+        keyX.reserve(count);
+        keyY.reserve(count);
+        index.reserve(count);
+    }
+};
+
+// Range filter kernel: appends to out every offset k in [0, count) whose
+// point (xs[k], ys[k]) is strictly within radius of center, comparing
+// squared distances a full SIMD vector at a time. Lane queries run it over
+// keyX / keyY and only look at the units it returns.
+void FilterWithinRadius(const float* xs, const float* ys, int count, Vec2 center, float radius,
+                        ArenaVector<int>& out);
+
+// Interned lane routes. All units starting from the same x on the same side
+// walk the same waypoints, so each route is built once and shared; units keep
+// only a route id and a cursor. Routes are never modified after creation.
+class PathTable {
+public:
+    int Intern(int startX, bool player);
+    const std::vector<Vec2>& Waypoints(int routeId) const { return routes[routeId].waypoints; }
+
+private:
+    struct Route {
+        int startX;
+        bool player;
+        std::vector<Vec2> waypoints;
+    };
+    std::vector<Route> routes;
+};
+
+// How the unit store's slots have been used. Kept across Clear, like the
+// storage itself.
+struct UnitPoolStats {
+    int capacity = 0;        // units the arrays hold without growing
+    int peakUnits = 0;       // most units at once, the high-water mark
+    int ids = 0;             // stable ids ever handed out
+    long long spawns = 0;
+    long long reusedIds = 0; // spawns that recycled the id of a removed unit
+    int growths = 0;         // spawns that found the store full and grew it
+};
+
+// Summed element size of the given vectors, for per-unit byte budgets
+template <typename... Columns>
+constexpr size_t ElementBytes() { return (sizeof(typename Columns::value_type) + ...); }
+
+// Contiguous structure-of-arrays storage for all units.
+// Index i in [0, Count()) refers to the same unit in every array. Removing a
+// unit swaps the last unit into its slot, so indices are dense but not stable;
+// use a UnitHandle (HandleAt / IndexOf) to remember a unit across removals.
+class UnitStore {
+public:
+    // Hot simulation state
+    std::vector<float> posX;
+    std::vector<float> posY;
+    std::vector<int> currentHP;
+    std::vector<float> attackTimer;
+    std::vector<float> freezeTimer;
+    std::vector<unsigned char> isPlayer;
+    std::vector<unsigned char> isAlive;
+    std::vector<unsigned char> isFrozen;
+    std::vector<UnitHandle> target; // current target, stale handle for none
+    std::vector<unsigned char> inTowerRange; // tracked by the opposing tower
+
+    std::vector<UnitType> type;
+
+    // Path following
+    std::vector<int> routeId;    // shared route in paths
+    std::vector<int> pathCursor; // next waypoint on the route
+
+    int Count() const { return (int)posX.size(); }
+    UnitHandle HandleAt(int index) const {
+        int id = indexToId[index];
+        return { id, generations[id] };
+    }
+    // Dense index of the unit, -1 once it has been removed
+    int IndexOf(UnitHandle handle) const {
+        if (handle.id < 0 || handle.id >= (int)idToIndex.size()) return -1;
+        if (generations[handle.id] != handle.generation) return -1;
+        return idToIndex[handle.id];
+    }
+    // Same for a raw slot id taken from a lane index
+    int IndexOfId(int id) const {
+        if (id < 0 || id >= (int)idToIndex.size()) return -1;
+        return idToIndex[id];
+    }
+    const UnitStats& Stats(int index) const { return GetUnitStats(type[index]); }
+    // Lane index of player (true) or enemy (false) units
+    const LaneIndex& Lane(bool player) const { return lanes[player ? 1 : 0]; }
+    // Waypoints of the unit's route; the unit is heading for Waypoints(i)[pathCursor[i]]
+    const std::vector<Vec2>& Waypoints(int index) const { return paths.Waypoints(routeId[index]); }
+    // Dense indices of alive units of one side strictly within radius of center
+    void QueryRadius(bool player, Vec2 center, float radius, ArenaVector<int>& out) const;
+    // Dense index of the unit's target, -1 if it has none or it is gone
+    int TargetIndex(int index) const;
+    // Dense index of lane entry k, -1 if the unit is gone or dead
+    int LaneUnit(const LaneIndex& lane, int k) const;
+
+    UnitHandle Spawn(UnitType unitType, bool player);
+    void Remove(int index);
+    void Clear();
+    // Room for count units in every array, ids and lane included
+    void Reserve(int count);
+    UnitPoolStats PoolStats() const;
+    void RefreshLaneIndex(float deltaTime);
+
+    // Two-phase unit update: BeginUpdates, PlanUpdate for every unit (any
+    // order, any thread) with MoveQueued after each run of PlanUpdate calls,
+    // then CommitUpdates with every thread's intents
+    void BeginUpdates();
+    void PlanUpdate(int index, float deltaTime, UnitIntents& intents);
+    void CommitUpdates(const std::vector<UnitIntents>& intents);
+    // Damage reduction: merges the damage of every buffer in stable id order,
+    // takes each target's total off its HP once, then kills every damaged
+    // unit at 0 HP or below. Bit-identical however the events were split.
+    void ResolveDamage(const std::vector<UnitIntents>& intents);
+    // Path following: QueueMove gathers a unit, MoveQueued moves every queued
+    // unit toward its waypoint with the SIMD kernel and empties the batch
+    void QueueMove(int index, MoveBatch& moves) const;
+    void MoveQueued(MoveBatch& moves, float deltaTime);
+    // The range filter's candidates go in arena
+    void FindTargetWithPriority(int index, FrameArena& arena);
+    void Attack(int index, int targetIndex, UnitIntents& intents);
+
+private:
+    std::vector<int> idToIndex; // stable id -> dense index, -1 when free
+    std::vector<unsigned> generations; // per stable id, bumped on removal
+    std::vector<int> indexToId; // dense index -> stable id
+    std::vector<int> freeIds;
+    std::vector<int> retiredIds;     // removed since the last lane refresh, not yet reusable
+    std::vector<int> pendingLaneIds; // spawned since the last lane refresh
+    LaneIndex lanes[2];              // [0] enemy units, [1] player units
+    std::vector<float> nextX; // planned positions, see PlanUpdate
+    std::vector<float> nextY;
+    std::vector<DamageEvent> mergedDamage; // ResolveDamage scratch
+    UnitPoolStats poolStats;
+    PathTable paths; // kept across Clear, routes do not depend on the match
+
+    void generatePath(int index);
+    float LaneDistance(const LaneIndex& lane, int k, float x, float y) const;
+    float CalculateDistance(float ax, float ay, float bx, float by) const;
+
+public:
+    // Every column indexed by dense unit index: the public state above plus
+    // indexToId, read by HandleAt, and nextX / nextY, copied and read back
+    // in full each tick. Stats and waypoints are shared, type picks them out
+    // of UNIT_STATS and routeId out of paths. Each column is its own stream,
+    // so this sum is not a count of cache lines touched. It is the memory
+    // bandwidth a unit costs when a tick walks every column in index order,
+    // budgeted at 64 bytes per unit.
+    static constexpr size_t HOT_BYTES_PER_UNIT = ElementBytes<
+        decltype(posX), decltype(posY), decltype(currentHP), decltype(attackTimer), decltype(freezeTimer),
+        decltype(isPlayer), decltype(isAlive), decltype(isFrozen), decltype(target), decltype(inTowerRange),
+        decltype(type), decltype(routeId), decltype(pathCursor), decltype(indexToId), decltype(nextX),
+        decltype(nextY)>();
+    static_assert(HOT_BYTES_PER_UNIT <= 64, "per-unit columns outgrew their 64 byte bandwidth budget");
+};
+
+// to find optimal path
+struct PathNode {
+    int x;
+    float cost;
+    bool operator > (const PathNode& other) const { //operator overloading
+        return cost > other.cost;
+    }
+};
+
+// Sort key for tower targets: closest 10px distance band first, then lowest
+// HP, then id. Banding keeps the "about as close -> weaker unit" rule while
+// still being a strict weak ordering, unlike a 10px tolerance compare.
+struct TowerTargetKey {
+    int band;
+    int hp;
+    int unitId;
+
+    bool operator < (const TowerTargetKey& other) const {
+        if (band != other.band) return band < other.band;
+        if (hp != other.hp) return hp < other.hp;
+        return unitId < other.unitId;
+    }
+};
+
+// Fixed timestep clock. Each render frame adds its real duration and gets back
+// the number of whole SIM_DT ticks to run. After a long stall at most
+// SIM_MAX_SUBSTEPS ticks run and the rest of the backlog is dropped, so the
+// sim slows down instead of spiralling.
+struct SimClock {
+    double accumulator = 0.0;
+    long long tick = 0;
+
+    int Advance(float frameTime);
+};
+
+// Small deterministic generator (xorshift32) for effects, so a match does not
+// depend on raylib's global random state
+struct SimRandom {
+    unsigned state;
+
+    explicit SimRandom(unsigned seed = 1) : state(seed ? seed : 1) {}
+    // Uniform integer in [min, max]
+    int Range(int min, int max);
+};
+
+// Wave management
+struct GameWave {
+    int waveNumber;
+    std::vector<WaveUnit> waveUnits;
+    float spawnRate; // at the start of a match, see Game::waveSpawnRates
+    float waveCooldown;
+    const GameWave* nextWave;
+
+    GameWave(int num, const std::vector<WaveUnit>& units, float rate, float cooldown = 10.0f)  //constructor
+        : waveNumber(num), waveUnits(units), spawnRate(rate), waveCooldown(cooldown), nextWave(nullptr) {}
+};
+
+// Head of the wave list shared by every game. Built on first use and never
+// changed afterwards, so games on different threads can read it at once.
+const GameWave* GetWaveList();
+
+class Projectile {
+public:
+    Vec2 startPos;
+    Vec2 endPos;
+    float progress;
+    bool active;
+    Rgba color;
+
+    Projectile(Vec2 start, Vec2 end, Rgba col) {
+        startPos = start;
+        endPos = end;
+        progress = 0.0f;
+        active = true;
+        color = col;
+    }
+    //updates projectile movement
+    void Update(float deltaTime) {
+        progress += deltaTime * 3.0f;
+        if (progress >= 1.0f) {
+            active = false;
+        }
+    }
+    Vec2 CurrentPosition() const {
+        return {
+            startPos.x + (endPos.x - startPos.x) * progress,
+            startPos.y + (endPos.y - startPos.y) * progress
+        };
+    }
+};
+
+// Fixed capacity ring of projectiles, oldest first. Every projectile lives
+// equally long, so they expire in the order they were pushed and expiry only
+// has to move the front. Pushing onto a full ring drops the oldest.
+class ProjectileRing {
+public:
+    explicit ProjectileRing(int capacity) { SetCapacity(capacity); }
+
+    // Drops every live projectile
+    void SetCapacity(int capacity);
+    int Capacity() const { return (int)ring.size(); }
+    int Count() const { return count; }
+
+    // k counts from the oldest
+    Projectile& operator [] (int k) { return ring[Slot(k)]; }
+    const Projectile& operator [] (int k) const { return ring[Slot(k)]; }
+
+    void Push(const Projectile& projectile);
+    // Drops inactive projectiles from the front
+    void ExpireFront();
+    void Clear() { head = 0; count = 0; }
+
+private:
+    std::vector<Projectile> ring;
+    int head = 0; // oldest
+    int count = 0;
+
+    int Slot(int k) const {
+        int slot = head + k;
+        return slot < (int)ring.size() ? slot : slot - (int)ring.size();
+    }
+};
+
+// Effect sources that are not units, they sort before every unit id
+const int EFFECT_SOURCE_FREEZE = -3;
+const int EFFECT_SOURCE_PLAYER_TOWER = -2;
+const int EFFECT_SOURCE_ENEMY_TOWER = -1;
+
+// An attack or freeze effect waiting to become a Projectile
+struct EffectSpawn {
+    int source;   // id of the unit that spawned it, or an EFFECT_SOURCE_* value
+    int sequence; // orders several effects from one source
+    Vec2 from;
+    Vec2 to;
+    Rgba color;
+};
+
+// Effects spawned during a tick. Each job system thread appends to its own
+// buffer, so no locking is needed. Drain merges them sorted by source and
+// sequence, so projectile order does not depend on how work was split.
+class EffectQueue {
+public:
+    EffectQueue() : buffers(1) {}
+
+    void SetThreadCount(int threads);
+    // Room for count effects per thread
+    void Reserve(int count);
+    void Push(int thread, const EffectSpawn& effect) { buffers[thread].push_back(effect); }
+    // Pushes every queued effect onto projectiles and empties the queue
+    void Drain(ProjectileRing& projectiles);
+    void Clear();
+
+private:
+    std::vector<std::vector<EffectSpawn>> buffers; // one per thread
+    std::vector<EffectSpawn> merged;
+};
+
+class Tower {
+public:
+    Vec2 position;   //For tower position
+    int currentHP;
+    int maxHP;
+    int damage;
+    float attackRate;
+    float attackTimer;
+    bool isPlayer;
+    bool isAlive;
+
+    // Enemy units currently inside TOWER_RANGE
+    std::vector<UnitHandle> inRange;
+
+    Tower(bool player) {
+        isPlayer = player;
+        Reset();
+    }
+
+    // Back to full health, keeps the storage of the range set
+    void Reset();
+    void Reserve(int units);
+    // arena holds the range filter's candidates
+    void Update(float deltaTime, UnitStore& units, FrameArena& arena);
+
+    bool CanAttack() {
+        return attackTimer >= attackRate;
+    }
+
+    void ResetAttackTimer() {
+        attackTimer = 0.0f;
+    }
+    void UpdateTargetQueue(UnitStore& units, FrameArena& arena);
+    UnitHandle GetBestTarget(const UnitStore& units);
+
+private:
+    float CalculateDistance(Vec2 a, Vec2 b);
+};
+
+// What the renderer needs of one tick, copied out of a Game by
+// WriteSnapshot so it can be drawn while the simulation moves on
+struct UnitSnapshot {
+    Vec2 position;
+    int currentHP;
+    UnitType type;
+    bool isPlayer;
+    bool isFrozen;
+    bool hasTarget;
+    Vec2 targetPosition;
+    // Rest of the unit's route. Points into the game's PathTable, which
+    // never moves or changes a route once it is interned.
+    const Vec2* waypoints;
+    int waypointCount;
+};
+
+struct TowerSnapshot {
+    Vec2 position;
+    int currentHP;
+    int maxHP;
+    bool isPlayer;
+    bool isAlive;
+};
+
+struct ProjectileSnapshot {
+    Vec2 position;
+    Rgba color;
+};
+
+struct RenderSnapshot {
+    long long tick = 0; // simulation ticks run before this snapshot
+    GameState state = GameState::START_SCREEN;
+    std::string winner;
+    TowerSnapshot playerTower = {};
+    TowerSnapshot enemyTower = {};
+    std::vector<UnitSnapshot> units;             // alive units
+    std::vector<ProjectileSnapshot> projectiles; // active effects
+
+    // UI
+    int playerElixir = 0;
+    int maxElixir = 0;
+    float gameTimer = 0.0f;
+    bool freezeAvailable = false;
+    float freezeCooldown = 0.0f;
+    const GameWave* currentWave = nullptr; // shared wave list, see GetWaveList
+    bool isBetweenWaves = false;
+    float betweenWavesTimer = 0.0f;
+    int currentUnitTypeIndex = 0;
+    int unitsSpawnedForCurrentType = 0;
+};
+
+// One match. Input reaches it only through Start / Restart / SpawnUnit /
+// ActivateFreeze, and time only through Update, so it runs the same with or
+// without a window.
+class Game {
+public:
+    GameState currentState;
+    Tower playerTower;
+    Tower enemyTower;
+    UnitStore units;
+    ProjectileRing projectiles;
+
+    // Freeze ability
+    bool freezeAvailable;
+    float freezeCooldown;
+    const float FREEZE_DURATION = 5.0f;
+    const float FREEZE_COOLDOWN = 30.0f;
+    int playerElixir;
+    const int MAX_ELIXIR = 10;
+    float elixirTimer;
+    const float ELIXIR_RATE = 2.0f;
+
+    // Wave progression using linked list
+    const GameWave* waveList;
+    const GameWave* currentWave;
+    std::vector<float> waveSpawnRates; // by waveNumber - 1, sped up each time the list repeats
+    float waveSpawnTimer;
+    int currentUnitTypeIndex;
+    int unitsSpawnedForCurrentType;
+    bool isBetweenWaves;
+    float betweenWavesTimer;
+
+    // 2 min timer
+    float gameTimer;
+    const float GAME_TIME_LIMIT = 120.0f;
+
+    bool gameOver;
+    std::string winner;
+
+    // Units spawned this match
+    int playerUnitsSpawned;
+    int enemyUnitsSpawned;
+
+    explicit Game(unsigned seed = 1);
+    Game(const Game&) = delete;
+    Game& operator = (const Game&) = delete;
+
+    void Start();
+    void Restart();
+    // Advances the simulation by one fixed tick (deltaTime is SIM_DT)
+    void Update(float deltaTime);
+    void SpawnUnit(UnitType type);
+    void ActivateFreeze();
+    void Reset();
+    // Seed for the next Reset / Restart. Containers keep their capacity
+    // across resets, so one game can play many matches without reallocating.
+    void SetSeed(unsigned matchSeed);
+    // Spreads the unit and projectile phases over jobs, which must
+    // outlive the game. nullptr (the default) runs everything on the caller.
+    void SetJobSystem(JobSystem* jobSystem);
+    // Copies the drawable state into out, reusing its storage
+    void WriteSnapshot(RenderSnapshot& out, long long tick) const;
+
+    // Largest capacity and peak over the threads' frame arenas, overflows summed
+    FrameArenaStats ArenaStats() const;
+
+    // The phases of one Update, in order (the lane index refresh runs between
+    // UpdateTimers and UpdateTowers). Public so benchmarks can time each one.
+    // ResetArenas empties every thread's frame arena and grows it to fit the
+    // units there are now.
+    void ResetArenas();
+    void UpdateTimers(float deltaTime);
+    void UpdateTowers(float deltaTime);
+    void UpdateUnits(float deltaTime);
+    void UpdateProjectiles(float deltaTime);
+    void HandleTowerAttacks();
+    void HandleWaveProgression(float deltaTime);
+
+private:
+    unsigned seed;
+    SimRandom random;
+    JobSystem* jobs = nullptr;
+    std::vector<UnitIntents> unitIntents; // one per job system thread
+    EffectQueue effects;                  // drained into projectiles once per tick
+
+    // Runs body(begin, end, thread) over [0, count) on the job system, or
+    // inline without one. Allocations in body count against the caller's tag.
+    template <typename Body>
+    void ForEachRange(int count, int minGrain, const Body& body);
+    // Sizes the per-thread buffers and reserves everything a busy match needs
+    void ReserveStorage();
+    // One empty UnitIntents per job system thread
+    void ResetIntents();
+
+    void CreateFreezeEffect();
+    // Safe from any job system thread, thread is the body's thread index
+    void CreateAttackEffect(int thread, int source, Vec2 from, Vec2 to, Rgba color);
+    void InitializeWaves();
+};